@@ -4,6 +4,19 @@ else
 	rm bin/*
 fi
 
-g++ -g -O0 -I . -o bin/interrupts_EP interrupts_101311131_101311339_EP.cpp
-g++ -g -O0 -I . -o bin/interrupts_RR interrupts_101311131_101311339_RR.cpp
-g++ -g -O0 -I . -o bin/interrupts_EP_RR interrupts_101311131_101311339_EP_RR.cpp
\ No newline at end of file
+#Debug build by default; "bash build.sh release" builds optimized binaries for benchmarking and big runs,
+#"bash build.sh profile" the same with the per-phase counters compiled in
+FLAGS="-g -O0"
+if [ "$1" = "release" ]; then
+    FLAGS="-O3 -flto=auto -DNDEBUG"
+elif [ "$1" = "profile" ]; then
+    FLAGS="-O3 -flto=auto -DNDEBUG -DINTERRUPTS_PROFILE"
+fi
+
+g++ $FLAGS -I . -pthread -o bin/interrupts interrupts_101311131_101311339.cpp
+g++ $FLAGS -I . -o bin/interrupts_EP interrupts_101311131_101311339_EP.cpp
+g++ $FLAGS -I . -o bin/interrupts_RR interrupts_101311131_101311339_RR.cpp
+g++ $FLAGS -I . -o bin/interrupts_EP_RR interrupts_101311131_101311339_EP_RR.cpp
+g++ $FLAGS -I . -o bin/trace_convert interrupts_101311131_101311339_trace_convert.cpp
+g++ $FLAGS -I . -o bin/trace_generate interrupts_101311131_101311339_generate.cpp
+g++ $FLAGS -I . -o bin/bench interrupts_101311131_101311339_bench.cpp
@@ -0,0 +1,18 @@
+/**
+ * @file interrupts_101311131_101311339.cpp
+ * @author Sasisekhar Govind, Yuvraj Bains, James Bian
+ * @brief Single simulator binary; the scheduling policy is picked with --policy, --batch runs a whole suite
+ *        and --sweep tabulates metrics over quanta and partition layouts
+ */
+
+#include "interrupts_101311131_101311339_sweep.hpp"
+
+int main(int argc, char** argv) {
+    if (argc > 1 && std::string(argv[1]) == "--batch") {
+        return batch_main(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "--sweep") {
+        return sweep_main(argc, argv);
+    }
+    return simulator_main(argc, argv, "");
+}
@@ -18,6 +18,23 @@
 #include<sstream>
 #include<iomanip>
 #include<algorithm>
+#include<iterator>
+#include<queue>
+#include<unordered_map>
+#include<map>
+#include<set>
+#include<memory>
+#include<memory_resource>
+#include<cstdio>
+#include<cstring>
+#include<cstdint>
+#include<climits>
+#include<type_traits>
+#include<unistd.h>
+#ifdef __SSE2__
+#include<emmintrin.h>
+#endif
+#include "interrupts_101311131_101311339_profile.hpp"
 
 //An enumeration of states to make assignment easier
 enum states {
@@ -26,7 +43,9 @@ enum states {
     RUNNING,
     WAITING,
     TERMINATED,
-    NOT_ASSIGNED
+    NOT_ASSIGNED,
+    SUSPENDED_READY,    //Swapped out and runnable, waiting for memory to swap back in
+    SUSPENDED_WAITING   //Swapped out while blocked on I/O
 };
 std::ostream& operator<<(std::ostream& os, const enum states& s) { //Overloading the << operator to make printing of the enum easier
 
@@ -36,22 +55,37 @@ std::ostream& operator<<(std::ostream& os, const enum states& s) { //Overloading
                                 "RUNNING",
                                 "WAITING",
                                 "TERMINATED",
-                                "NOT_ASSIGNED"
+                                "NOT_ASSIGNED",
+                                "SUSPENDED_READY",
+                                "SUSPENDED_WAITING"
     };
     return (os << state_names[s]);
 }
 
+//Name of a state as it appears in the execution table; the suspended states are shortened to fit its
+//10 character columns
+const char* state_name(states s) {
+    static const char* state_names[] = {
+                                "NEW",
+                                "READY",
+                                "RUNNING",
+                                "WAITING",
+                                "TERMINATED",
+                                "NOT_ASSIGNED",
+                                "SUSP_READY",
+                                "SUSP_WAIT"
+    };
+    return state_names[s];
+}
+
+//Lottery tickets of a process whose trace line does not give any
+const unsigned int DEFAULT_TICKETS = 100;
+
+//A block of memory as reported by the allocators; occupied holds the owning PID or -1 when free
 struct memory_partition{
     unsigned int    partition_number;
     unsigned int    size;
     int             occupied;
-} memory_paritions[] = {
-    {1, 40, -1},
-    {2, 25, -1},
-    {3, 15, -1},
-    {4, 10, -1},
-    {5, 8, -1},
-    {6, 2, -1}
 };
 
 struct PCB{
@@ -65,6 +99,383 @@ struct PCB{
     enum states     state;
     unsigned int    io_freq;
     unsigned int    io_duration;
+    int             priority;           //Lower runs first under EP and EP_RR; the PID unless the trace gives one
+    unsigned int    tickets;            //Share of the CPU under STRIDE and LOTTERY; DEFAULT_TICKETS unless the trace gives them
+};
+
+//The PCB pool: every job of the run lives in the table exactly once, in input order, from before it
+//arrives until the end. The ready and wait queues hold handles (row numbers), and the PID index, built
+//once up front, makes syncing a process back constant time without allocating.
+//The table is stored as one column per PCB field, so a scan over one field streams through contiguous
+//memory instead of dragging whole records through the cache. get() and set() give the per-PCB view.
+struct process_table {
+    //Hot columns, rewritten as the process moves between states
+    std::vector<std::uint8_t>               state;
+    std::vector<unsigned int>               remaining_time;
+    std::vector<int>                        start_time;
+    std::vector<int>                        partition_number;
+    std::vector<unsigned int>               last_cpu;   //CPU the process last ran on; not part of the PCB view
+    std::vector<std::uint8_t>               level;      //MLFQ level, valid while level_epoch matches the policy's boost count
+    std::vector<unsigned int>               level_epoch;
+    std::vector<unsigned long long>         pass_base;  //STRIDE pass before any CPU time is charged
+
+    //Cold columns, fixed once the trace is loaded
+    std::vector<int>                        PID;
+    std::vector<unsigned int>               size;
+    std::vector<unsigned int>               arrival_time;
+    std::vector<unsigned int>               processing_time;
+    std::vector<unsigned int>               io_freq;
+    std::vector<unsigned int>               io_duration;
+    std::vector<int>                        priority;
+    std::vector<unsigned int>               tickets;
+
+    std::unordered_map<int, std::size_t>    handles;
+    std::size_t                             live = 0;   //Admitted processes that have not terminated yet
+
+    std::size_t rows() const {
+        return PID.size();
+    }
+
+    PCB get(std::size_t handle) const {
+        PCB process;
+        process.PID = PID[handle];
+        process.size = size[handle];
+        process.arrival_time = arrival_time[handle];
+        process.start_time = start_time[handle];
+        process.processing_time = processing_time[handle];
+        process.remaining_time = remaining_time[handle];
+        process.partition_number = partition_number[handle];
+        process.state = (states)state[handle];
+        process.io_freq = io_freq[handle];
+        process.io_duration = io_duration[handle];
+        process.priority = priority[handle];
+        process.tickets = tickets[handle];
+        return process;
+    }
+
+    //Writes back the fields a process can change; the cold columns never do
+    void set(std::size_t handle, const PCB &process) {
+        state[handle] = process.state;
+        remaining_time[handle] = process.remaining_time;
+        start_time[handle] = process.start_time;
+        partition_number[handle] = process.partition_number;
+    }
+
+    //Only the hot columns change during a run, so only they go into a checkpoint
+    template <typename Writer>
+    void save(Writer &out) const {
+        out.put_vector(state);
+        out.put_vector(remaining_time);
+        out.put_vector(start_time);
+        out.put_vector(partition_number);
+        out.put_vector(last_cpu);
+        out.put_vector(level);
+        out.put_vector(level_epoch);
+        out.put_vector(pass_base);
+        out.put(live);
+    }
+
+    template <typename Reader>
+    bool load(Reader &in) {
+        std::size_t n = rows();
+        return in.get_vector(state) && in.get_vector(remaining_time) && in.get_vector(start_time) && in.get_vector(partition_number)
+               && in.get_vector(last_cpu) && in.get_vector(level) && in.get_vector(level_epoch) && in.get_vector(pass_base)
+               && in.get(live) && state.size() == n && remaining_time.size() == n && start_time.size() == n
+               && partition_number.size() == n && last_cpu.size() == n && level.size() == n && level_epoch.size() == n
+               && pass_base.size() == n;
+    }
+
+    void push_back(const PCB &process) {
+        state.push_back(process.state);
+        remaining_time.push_back(process.remaining_time);
+        start_time.push_back(process.start_time);
+        partition_number.push_back(process.partition_number);
+        last_cpu.push_back(0);
+        level.push_back(0);
+        level_epoch.push_back(0);
+        pass_base.push_back(0);
+        PID.push_back(process.PID);
+        size.push_back(process.size);
+        arrival_time.push_back(process.arrival_time);
+        processing_time.push_back(process.processing_time);
+        io_freq.push_back(process.io_freq);
+        io_duration.push_back(process.io_duration);
+        priority.push_back(process.priority);
+        tickets.push_back(process.tickets);
+    }
+};
+
+//------------------------------------COLUMN SCANS------------------------------------------------------
+//Bulk queries over process_table columns, four lanes at a time with SSE2 where the target has it (every
+//x86-64 does) and one at a time otherwise. SSE2 only compares signed integers, so unsigned values are
+//biased by 2^31 first, which maps unsigned order onto signed order.
+
+//Length of the prefix of values[0, n) in which every value is <= limit
+std::size_t prefix_not_after(const unsigned int* values, std::size_t n, unsigned int limit) {
+    std::size_t i = 0;
+#ifdef __SSE2__
+    const __m128i bias = _mm_set1_epi32(INT_MIN);
+    const __m128i biased_limit = _mm_xor_si128(_mm_set1_epi32((int)limit), bias);
+    for (; i + 4 <= n; i += 4) {
+        __m128i lane = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(values + i)), bias);
+        int after = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(lane, biased_limit)));
+        if (after != 0) {
+            return i + __builtin_ctz(after);
+        }
+    }
+#endif
+    while (i < n && values[i] <= limit) {
+        i++;
+    }
+    return i;
+}
+
+//Returns true if values[0, n) never decreases
+bool non_decreasing(const unsigned int* values, std::size_t n) {
+    if (n < 2) {
+        return true;
+    }
+    std::size_t i = 0;
+#ifdef __SSE2__
+    const __m128i bias = _mm_set1_epi32(INT_MIN);
+    for (; i + 5 <= n; i += 4) {
+        __m128i current = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(values + i)), bias);
+        __m128i next = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(values + i + 1)), bias);
+        if (_mm_movemask_epi8(_mm_cmpgt_epi32(current, next)) != 0) {
+            return false;
+        }
+    }
+#endif
+    for (; i + 1 < n; i++) {
+        if (values[i] > values[i + 1]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+//Min-heap of process handles keyed on Key, with FIFO order between equal keys
+template <typename Key>
+struct handle_heap {
+    struct entry {
+        Key                 key;
+        unsigned long long  order;
+        std::size_t         handle;
+    };
+
+    std::vector<entry>  heap;
+    unsigned long long  next_order = 0;
+
+    //Heap comparator: true if a should come out after b
+    static bool comes_after(const entry &a, const entry &b) {
+        if (a.key != b.key) {
+            return a.key > b.key;
+        }
+        return a.order > b.order;
+    }
+
+    bool empty() const {
+        return heap.empty();
+    }
+
+    std::size_t size() const {
+        return heap.size();
+    }
+
+    //Makes room for n entries so pushes up to that depth never allocate
+    void reserve(std::size_t n) {
+        heap.reserve(n);
+    }
+
+    void push(std::size_t handle, Key key) {
+        heap.push_back({key, next_order++, handle});
+        std::push_heap(heap.begin(), heap.end(), comes_after);
+    }
+
+    std::size_t top() const {
+        return heap.front().handle;
+    }
+
+    Key top_key() const {
+        return heap.front().key;
+    }
+
+    std::size_t pop() {
+        std::pop_heap(heap.begin(), heap.end(), comes_after);
+        std::size_t handle = heap.back().handle;
+        heap.pop_back();
+        return handle;
+    }
+
+    //The heap is saved in its internal order, so it pops exactly as before once loaded
+    template <typename Writer>
+    void save(Writer &out) const {
+        out.put_vector(heap);
+        out.put(next_order);
+    }
+
+    template <typename Reader>
+    bool load(Reader &in) {
+        return in.get_vector(heap) && in.get(next_order);
+    }
+};
+
+//Ready processes keyed on priority (lower value runs first). EP and EP_RR dispatch with pop()
+//and check for preemption with top_key()
+typedef handle_heap<int> ready_heap;
+
+//Blocked processes keyed on the tick their I/O completes, so only finished I/O is ever touched
+typedef handle_heap<unsigned int> io_heap;
+
+//Ready processes keyed on the CPU time they have left (SJF and SRTF)
+typedef handle_heap<unsigned int> burst_heap;
+
+//FIFO of process handles in a ring buffer: unlike std::deque it never allocates once it has reached
+//its high-water mark, and reserve() gets it there up front
+struct handle_ring {
+    std::vector<std::size_t>    slots;
+    std::size_t                 head = 0;
+    std::size_t                 count = 0;
+
+    void reserve(std::size_t n) {
+        if (n > slots.size()) {
+            grow(n);
+        }
+    }
+
+    bool empty() const {
+        return count == 0;
+    }
+
+    std::size_t size() const {
+        return count;
+    }
+
+    void push_back(std::size_t handle) {
+        if (count == slots.size()) {
+            grow(std::max<std::size_t>(16, 2 * slots.size()));
+        }
+        std::size_t tail = head + count;
+        slots[tail < slots.size() ? tail : tail - slots.size()] = handle;
+        count++;
+    }
+
+    std::size_t pop_front() {
+        std::size_t handle = slots[head];
+        head = (head + 1 < slots.size()) ? head + 1 : 0;
+        count--;
+        return handle;
+    }
+
+    //Saved front to back
+    template <typename Writer>
+    void save(Writer &out) const {
+        std::vector<std::size_t> queued;
+        for (std::size_t i = 0; i < count; i++) {
+            std::size_t at = head + i;
+            queued.push_back(slots[at < slots.size() ? at : at - slots.size()]);
+        }
+        out.put_vector(queued);
+    }
+
+    template <typename Reader>
+    bool load(Reader &in) {
+        std::vector<std::size_t> queued;
+        if (!in.get_vector(queued)) {
+            return false;
+        }
+        head = 0;
+        count = 0;
+        for (std::size_t handle : queued) {
+            push_back(handle);
+        }
+        return true;
+    }
+
+private:
+    void grow(std::size_t capacity) {
+        std::vector<std::size_t> larger(capacity);
+        for (std::size_t i = 0; i < count; i++) {
+            std::size_t from = head + i;
+            larger[i] = slots[from < slots.size() ? from : from - slots.size()];
+        }
+        slots.swap(larger);
+        head = 0;
+    }
+};
+
+//Ticket counts of the queued processes in a Fenwick (binary indexed) tree over their handles, so adding a
+//process, removing one and finding who holds the n-th ticket all take O(log n)
+struct ticket_tree {
+    std::vector<unsigned long long> tree;   //1-based partial sums
+    std::vector<unsigned int>       held;   //Tickets of each handle, 0 when it is not queued
+    unsigned long long              total = 0;
+    std::size_t                     count = 0;
+
+    //Sizes the tree for handles 0..n-1; has to be called before the first add
+    void reserve(std::size_t n) {
+        if (n > held.size()) {
+            tree.assign(n + 1, 0);
+            held.assign(n, 0);
+        }
+    }
+
+    bool empty() const {
+        return count == 0;
+    }
+
+    std::size_t size() const {
+        return count;
+    }
+
+    void add(std::size_t handle, unsigned int tickets) {
+        held[handle] = tickets;
+        for (std::size_t i = handle + 1; i < tree.size(); i += i & (0 - i)) {
+            tree[i] += tickets;
+        }
+        total += tickets;
+        count++;
+    }
+
+    void remove(std::size_t handle) {
+        unsigned int tickets = held[handle];
+        for (std::size_t i = handle + 1; i < tree.size(); i += i & (0 - i)) {
+            tree[i] -= tickets;
+        }
+        held[handle] = 0;
+        total -= tickets;
+        count--;
+    }
+
+    //Handle holding ticket number n, counting from 0 in handle order; n has to be below total
+    std::size_t find(unsigned long long n) const {
+        std::size_t step = 1;
+        while (step * 2 < tree.size()) {
+            step *= 2;
+        }
+        std::size_t pos = 0;
+        for (; step > 0; step /= 2) {
+            if (pos + step < tree.size() && tree[pos + step] <= n) {
+                pos += step;
+                n -= tree[pos];
+            }
+        }
+        return pos;
+    }
+
+    template <typename Writer>
+    void save(Writer &out) const {
+        out.put_vector(tree);
+        out.put_vector(held);
+        out.put(total);
+        out.put(count);
+    }
+
+    template <typename Reader>
+    bool load(Reader &in) {
+        std::size_t n = held.size();
+        return in.get_vector(tree) && in.get_vector(held) && in.get(total) && in.get(count) && held.size() == n && tree.size() == n + 1;
+    }
 };
 
 //------------------------------------HELPER FUNCTIONS FOR THE SIMULATOR------------------------------
@@ -84,7 +495,7 @@ std::vector<std::string> split_delim(std::string input, std::string delim) {
 }
 
 //Function that takes a queue as an input and outputs a string table of PCBs
-std::string print_PCB(std::vector<PCB> _PCB) {
+std::string print_PCB(const std::vector<PCB> &_PCB) {
     const int tableWidth = 83;
 
     std::stringstream buffer;
@@ -138,7 +549,7 @@ std::string print_PCB(std::vector<PCB> _PCB) {
 }
 
 //Overloaded function that takes a single PCB as input
-std::string print_PCB(PCB _PCB) {
+std::string print_PCB(const PCB &_PCB) {
     std::vector<PCB> temp;
     temp.push_back(_PCB);
     return print_PCB(temp);
@@ -200,13 +611,72 @@ std::string print_exec_footer() {
     return buffer.str();
 }
 
-//Synchronize the process in the process queue
-void sync_queue(std::vector<PCB> &process_queue, PCB _process) {
-    for(auto &process : process_queue) {
-        if(process.PID == _process.PID) {
-            process = _process;
-        }
+//Multi-CPU runs add a CPU column after the time
+std::string print_smp_exec_header() {
+
+    const int tableWidth = 54;
+
+    std::stringstream buffer;
+
+    buffer << "+" << std::setfill('-') << std::setw(tableWidth) << "+" << std::endl;
+
+    buffer  << "|"
+            << std::setfill(' ') << std::setw(18) << "Time of Transition"
+            << std::setw(2) << "|"
+            << std::setfill(' ') << std::setw(3) << "CPU"
+            << std::setw(2) << "|"
+            << std::setfill(' ') << std::setw(3) << "PID"
+            << std::setw(2) << "|"
+            << std::setfill(' ') << std::setw(10) << "Old State"
+            << std::setw(2) << "|"
+            << std::setfill(' ') << std::setw(10) << "New State"
+            << std::setw(2) << "|" << std::endl;
+
+    buffer << "+" << std::setfill('-') << std::setw(tableWidth) << "+" << std::endl;
+
+    return buffer.str();
+}
+
+std::string print_smp_exec_footer() {
+    const int tableWidth = 54;
+    std::stringstream buffer;
+
+    buffer << "+" << std::setfill('-') << std::setw(tableWidth) << "+" << std::endl;
+
+    return buffer.str();
+}
+
+//Copies every job of the run into the pool columns and indexes it by PID
+process_table make_process_table(const std::vector<PCB> &jobs) {
+    PROFILE_SCOPE(PHASE_SETUP);
+    process_table table;
+    table.handles.reserve(jobs.size());
+    for (std::size_t handle = 0; handle < jobs.size(); handle++) {
+        table.push_back(jobs[handle]);
+        table.handles[jobs[handle].PID] = handle;
+    }
+    return table;
+}
+
+//Counts a pooled job as admitted; it now has to terminate before the run can end
+void add_to_table(process_table &table, std::size_t handle) {
+    if (table.state[handle] != TERMINATED) {
+        table.live++;
+    }
+}
+
+//Returns the handle of an admitted process
+std::size_t handle_of(const process_table &table, int PID) {
+    return table.handles.at(PID);
+}
+
+//Synchronize the process in the process table
+void sync_queue(process_table &table, const PCB &_process) {
+    std::size_t handle = handle_of(table, _process.PID);
+    if (table.state[handle] != TERMINATED && _process.state == TERMINATED) {
+        table.live--;
     }
+    table.set(handle, _process);
 }
 
 //Writes a string to a file
@@ -224,129 +694,1455 @@ void write_output(std::string execution, const char* filename) {
     std::cout << "Output generated in " << filename << ".txt" << std::endl;
 }
 
-//--------------------------------------------FUNCTIONS FOR THE "OS"-------------------------------------
+//------------------------------------STREAMING OUTPUT-------------------------------------------------
+//Logs are written through a fixed-size buffer that is flushed to disk whenever it fills up, so memory
+//use stays flat however long the run is. Rows are formatted by hand instead of through stringstreams.
 
-//Assign memory partition to program
-bool assign_memory(PCB &program) {
-    int size_to_fit = program.size;
-    int available_size = 0;
+class trace_writer {
+public:
+    static const std::size_t BUFFER_SIZE = 1 << 16;
+
+    //keep_contents opens an existing file without truncating it, for resuming at a checkpoint
+    explicit trace_writer(const char* filename, bool keep_contents = false) : buffer(BUFFER_SIZE) {
+        file = std::fopen(filename, keep_contents ? "r+b" : "wb");
+    }
+
+    ~trace_writer() {
+        close();
+    }
+
+    trace_writer(const trace_writer &) = delete;
+    trace_writer &operator=(const trace_writer &) = delete;
+
+    bool is_open() const {
+        return file != nullptr;
+    }
 
-    for(int i = 5; i >= 0; i--) {
-        available_size = memory_paritions[i].size;
+    //False once any write or the close has failed, e.g. on a full disk
+    bool ok() const {
+        return !failed;
+    }
 
-        if(size_to_fit <= available_size && memory_paritions[i].occupied == -1) {
-            memory_paritions[i].occupied = program.PID;
-            program.partition_number = memory_paritions[i].partition_number;
-            return true;
+    void write(const char* text, std::size_t length) {
+        if (used + length > buffer.size()) {
+            flush();
+            if (length > buffer.size()) {
+                if (file == nullptr || std::fwrite(text, 1, length, file) != length) {
+                    failed = true;
+                }
+                return;
+            }
         }
+        std::memcpy(buffer.data() + used, text, length);
+        used += length;
     }
 
-    return false;
-}
+    void write(const char* text) {
+        write(text, std::strlen(text));
+    }
 
-//Free a memory partition
-bool free_memory(PCB &program){
-    for(int i = 5; i >= 0; i--) {
-        if(program.PID == memory_paritions[i].occupied) {
-            memory_paritions[i].occupied = -1;
-            program.partition_number = -1;
-            return true;
+    void write(const std::string &text) {
+        write(text.data(), text.size());
+    }
+
+    void write(char c) {
+        if (used == buffer.size()) {
+            flush();
         }
+        buffer[used++] = c;
     }
-    return false;
-}
 
-//Convert a list of strings into a PCB
-PCB add_process(std::vector<std::string> tokens) {
-    PCB process;
-    process.PID = std::stoi(tokens[0]);
-    process.size = std::stoi(tokens[1]);
-    process.arrival_time = std::stoi(tokens[2]);
-    process.processing_time = std::stoi(tokens[3]);
-    process.remaining_time = std::stoi(tokens[3]);
-    process.io_freq = std::stoi(tokens[4]);
-    process.io_duration = std::stoi(tokens[5]);
-    process.start_time = -1;
-    process.partition_number = -1;
-    process.state = NOT_ASSIGNED;
+    //Writes value in decimal
+    void write_int(long long value) {
+        char digits[24];
+        std::size_t length = format_int(value, digits);
+        write(digits, length);
+    }
 
-    return process;
-}
+    //Writes value right-aligned in a field of width characters, like std::setw
+    void write_padded(long long value, std::size_t width) {
+        char digits[24];
+        std::size_t length = format_int(value, digits);
+        pad(length, width);
+        write(digits, length);
+    }
+
+    void write_padded(const char* text, std::size_t width) {
+        std::size_t length = std::strlen(text);
+        pad(length, width);
+        write(text, length);
+    }
+
+    void flush() {
+        if (used > 0 && (file == nullptr || std::fwrite(buffer.data(), 1, used, file) != used)) {
+            failed = true;
+        }
+        used = 0;
+    }
+
+    //Closes the file. Returns false if anything failed to reach it
+    bool close() {
+        if (file != nullptr) {
+            flush();
+            failed = (std::fclose(file) != 0) || failed;
+            file = nullptr;
+        }
+        return ok();
+    }
+
+    //Closes the file without writing out what is still buffered, leaving it as it was at the last flush
+    void abandon() {
+        used = 0;
+        if (file != nullptr) {
+            std::fclose(file);
+            file = nullptr;
+        }
+    }
 
-//Returns true if all processes in the queue have terminated
-bool all_process_terminated(std::vector<PCB> processes) {
+    //Hands everything written so far to the OS and returns the file length
+    long long sync() {
+        flush();
+        if (std::fflush(file) != 0) {
+            failed = true;
+        }
+        return std::ftell(file);
+    }
 
-    for(auto process : processes) {
-        if(process.state != TERMINATED) {
+    //Cuts the file back to offset bytes and continues writing there; anything written since the last
+    //sync() is dropped. Returns false if the file is shorter than offset
+    bool rewind_to(long long offset) {
+        used = 0;
+        std::fflush(file);
+        if (std::fseek(file, 0, SEEK_END) != 0 || std::ftell(file) < offset) {
             return false;
         }
+        return ftruncate(fileno(file), offset) == 0 && std::fseek(file, offset, SEEK_SET) == 0;
     }
 
-    return true;
-}
+private:
+    //Formats value into digits (not null terminated) and returns the number of characters used
+    static std::size_t format_int(long long value, char* digits) {
+        char reversed[24];
+        std::size_t length = 0;
+        unsigned long long magnitude = (value < 0) ? 0ULL - (unsigned long long)value : (unsigned long long)value;
+        do {
+            reversed[length++] = (char)('0' + magnitude % 10);
+            magnitude /= 10;
+        } while (magnitude > 0);
 
-//Terminates a given process
-void terminate_process(PCB &running, std::vector<PCB> &job_queue) {
-    running.remaining_time = 0;
-    running.state = TERMINATED;
-    free_memory(running);
-    sync_queue(job_queue, running);
-}
+        std::size_t out = 0;
+        if (value < 0) {
+            digits[out++] = '-';
+        }
+        while (length > 0) {
+            digits[out++] = reversed[--length];
+        }
+        return out;
+    }
 
-//set the process in the ready queue to runnning
-void run_process(PCB &running, std::vector<PCB> &job_queue, std::vector<PCB> &ready_queue, unsigned int current_time) {
-    running = ready_queue.back();
-    ready_queue.pop_back();
-    running.start_time = current_time;
-    running.state = RUNNING;
-    sync_queue(job_queue, running);
+    void pad(std::size_t length, std::size_t width) {
+        for (std::size_t i = length; i < width; i++) {
+            write(' ');
+        }
+    }
+
+    std::FILE*          file = nullptr;
+    std::vector<char>   buffer;
+    std::size_t         used = 0;
+    bool                failed = false;
+};
+
+//Streaming equivalent of print_exec_status
+void write_exec_status(trace_writer &out, unsigned int current_time, int PID, states old_state, states new_state) {
+    out.write('|');
+    out.write_padded(current_time, 18);
+    out.write(" |", 2);
+    out.write_padded(PID, 3);
+    out.write(" |", 2);
+    out.write_padded(state_name(old_state), 10);
+    out.write(" |", 2);
+    out.write_padded(state_name(new_state), 10);
+    out.write(" |\n", 3);
 }
 
-void idle_CPU(PCB &running) {
-    running.start_time = 0;
-    running.processing_time = 0;
-    running.remaining_time = 0;
-    running.arrival_time = 0;
-    running.io_duration = 0;
-    running.io_freq = 0;
-    running.partition_number = 0;
-    running.size = 0;
-    running.state = NOT_ASSIGNED;
-    running.PID = -1;
+//Row of the multi-CPU execution table
+void write_exec_status(trace_writer &out, unsigned int current_time, unsigned int cpu, int PID, states old_state, states new_state) {
+    out.write('|');
+    out.write_padded(current_time, 18);
+    out.write(" |", 2);
+    out.write_padded(cpu, 3);
+    out.write(" |", 2);
+    out.write_padded(PID, 3);
+    out.write(" |", 2);
+    out.write_padded(state_name(old_state), 10);
+    out.write(" |", 2);
+    out.write_padded(state_name(new_state), 10);
+    out.write(" |\n", 3);
 }
 
-//This was implemented for the bonus
-//I could have implemented inside of each indivudal cpp file but decided this was the best and most simple course
-//of action since I could reference it directly inside all the others files
+//------------------------------------CHECKPOINT STREAMS-----------------------------------------------
+//A checkpoint is a flat dump in host byte order: every component writes its fields in a fixed order and
+//reads them back in the same order. Only trivially copyable values go in; vectors carry their length.
 
-std::string get_memory_status(unsigned int current_time) {
-    std::stringstream ss;
-    unsigned int total_used_mem = 0;
-    unsigned int total_free_mem = 0;
+class checkpoint_writer {
+public:
+    explicit checkpoint_writer(const char* filename) {
+        file = std::fopen(filename, "wb");
+    }
 
-    ss << "Time: " << current_time << "\n"
-       << "Partition Status:\n";
+    ~checkpoint_writer() {
+        close();
+    }
 
-    for (const auto& part : memory_paritions) {
-        ss << "  Part " << part.partition_number 
-           << " [" << part.size << "MB]: ";
-        
-        if (part.occupied != -1) {
-            ss << "Occupied by PID " << part.occupied;
-            total_used_mem += part.size;
-        } else {
-            ss << "Free";
-            total_free_mem += part.size;
+    checkpoint_writer(const checkpoint_writer &) = delete;
+    checkpoint_writer &operator=(const checkpoint_writer &) = delete;
+
+    bool is_open() const {
+        return file != nullptr;
+    }
+
+    template <typename T>
+    void put(const T &value) {
+        static_assert(std::is_trivially_copyable<T>::value, "checkpoints hold plain values only");
+        ok = ok && std::fwrite(&value, sizeof(T), 1, file) == 1;
+    }
+
+    template <typename T>
+    void put_vector(const std::vector<T> &values) {
+        static_assert(std::is_trivially_copyable<T>::value, "checkpoints hold plain values only");
+        put<std::uint64_t>(values.size());
+        ok = ok && std::fwrite(values.data(), sizeof(T), values.size(), file) == values.size();
+    }
+
+    void put_string(const std::string &text) {
+        put_vector(std::vector<char>(text.begin(), text.end()));
+    }
+
+    //Closes the file. Returns false if anything failed to reach it
+    bool close() {
+        if (file != nullptr) {
+            ok = (std::fclose(file) == 0) && ok;
+            file = nullptr;
         }
-        ss << "\n";
+        return ok;
     }
 
-    ss << "Stats:\n"
-       << "  Total Memory Used: " << total_used_mem << " MB\n"
-       << "  Total Free Memory: " << total_free_mem << " MB\n"
-       << "--------------------------------------------------\n";
+private:
+    std::FILE*  file = nullptr;
+    bool        ok = true;
+};
+
+class checkpoint_reader {
+public:
+    explicit checkpoint_reader(const char* filename) {
+        file = std::fopen(filename, "rb");
+        if (file != nullptr && std::fseek(file, 0, SEEK_END) == 0) {
+            remaining = std::ftell(file);
+            std::rewind(file);
+        }
+    }
+
+    ~checkpoint_reader() {
+        if (file != nullptr) {
+            std::fclose(file);
+        }
+    }
+
+    checkpoint_reader(const checkpoint_reader &) = delete;
+    checkpoint_reader &operator=(const checkpoint_reader &) = delete;
+
+    bool is_open() const {
+        return file != nullptr;
+    }
+
+    //False once anything could not be read
+    bool good() const {
+        return ok;
+    }
+
+    template <typename T>
+    bool get(T &value) {
+        static_assert(std::is_trivially_copyable<T>::value, "checkpoints hold plain values only");
+        ok = ok && sizeof(T) <= remaining && std::fread(&value, sizeof(T), 1, file) == 1;
+        remaining -= ok ? sizeof(T) : 0;
+        return ok;
+    }
+
+    template <typename T>
+    bool get_vector(std::vector<T> &values) {
+        static_assert(std::is_trivially_copyable<T>::value, "checkpoints hold plain values only");
+        std::uint64_t count = 0;
+        //A corrupt length must not turn into a huge allocation
+        if (!get(count) || count > remaining / sizeof(T)) {
+            return ok = false;
+        }
+        values.resize(count);
+        ok = std::fread(values.data(), sizeof(T), count, file) == count;
+        remaining -= ok ? count * sizeof(T) : 0;
+        return ok;
+    }
+
+    bool get_string(std::string &text) {
+        std::vector<char> characters;
+        if (!get_vector(characters)) {
+            return false;
+        }
+        text.assign(characters.begin(), characters.end());
+        return true;
+    }
+
+private:
+    std::FILE*      file = nullptr;
+    std::size_t     remaining = 0;
+    bool            ok = true;
+};
+
+//--------------------------------------------FUNCTIONS FOR THE "OS"-------------------------------------
+
+//------------------------------------MEMORY ALLOCATORS-------------------------------------------------
+//Memory is handed out by an allocator picked at runtime. Every backend reports its blocks as
+//memory_partition entries in address order, so the memory log has the same shape for all of them.
+
+class memory_allocator {
+public:
+    virtual ~memory_allocator() {}
+
+    //Reserve memory for program and record where in program.partition_number
+    virtual bool assign(PCB &program) = 0;
+
+    //Release the memory held by program
+    virtual bool release(PCB &program) = 0;
+
+    //Current blocks in address order
+    virtual void layout(std::vector<memory_partition> &blocks) const = 0;
+
+    //Size of the largest free block: assign() takes exactly the programs no larger than it. Returns false
+    //if no block is free, when assign() takes nothing at all
+    virtual bool largest_free(unsigned int &size) const = 0;
+
+    //Writes the allocation state to a checkpoint
+    virtual void save(checkpoint_writer &out) const = 0;
+
+    //Restores what save() wrote. Returns false if it does not describe this allocator
+    virtual bool load(checkpoint_reader &in) = 0;
+
+    //Makes room for up to programs allocations at once, so the simulation loop never grows the allocator
+    virtual void reserve(std::size_t programs) {
+        (void)programs;
+    }
+};
+
+//Fixed partitions handed out best-fit, ties going to the later partition (the original scan ran from the
+//last partition to the first). Partitions are ranked by that preference once, and a bitmap over the ranks
+//marks the free ones, so a fit is a binary search plus a bit scan and nothing is allocated after setup
+class fixed_partition_allocator : public memory_allocator {
+public:
+    explicit fixed_partition_allocator(const std::vector<unsigned int> &sizes) {
+        for (std::size_t i = 0; i < sizes.size(); i++) {
+            partitions.push_back({(unsigned int)(i + 1), sizes[i], -1});
+            by_rank.push_back(i);
+        }
+        std::sort(by_rank.begin(), by_rank.end(), [this](std::size_t a, std::size_t b) {
+            return partitions[a].size != partitions[b].size ? partitions[a].size < partitions[b].size : a > b;
+        });
+        for (std::size_t i : by_rank) {
+            rank_sizes.push_back(partitions[i].size);
+        }
+        rank_of.resize(partitions.size());
+        for (std::size_t rank = 0; rank < by_rank.size(); rank++) {
+            rank_of[by_rank[rank]] = rank;
+        }
+        free_ranks.assign((partitions.size() + 63) / 64, 0);
+        for (std::size_t rank = 0; rank < partitions.size(); rank++) {
+            set_free(rank, true);
+        }
+    }
+
+    bool assign(PCB &program) override {
+        std::size_t rank = first_free(std::lower_bound(rank_sizes.begin(), rank_sizes.end(), program.size) - rank_sizes.begin());
+        if (rank == partitions.size()) {
+            return false;
+        }
+        std::size_t i = by_rank[rank];
+        set_free(rank, false);
+
+        partitions[i].occupied = program.PID;
+        program.partition_number = partitions[i].partition_number;
+        return true;
+    }
+
+    bool release(PCB &program) override {
+        std::size_t i = program.partition_number - 1;
+        if (program.partition_number < 1 || i >= partitions.size() || partitions[i].occupied != program.PID) {
+            return false;
+        }
+
+        partitions[i].occupied = -1;
+        set_free(rank_of[i], true);
+        program.partition_number = -1;
+        return true;
+    }
+
+    void layout(std::vector<memory_partition> &blocks) const override {
+        blocks = partitions;
+    }
+
+    bool largest_free(unsigned int &size) const override {
+        for (std::size_t word = free_ranks.size(); word-- > 0;) {
+            if (free_ranks[word] != 0) {
+                size = rank_sizes[word * 64 + 63 - __builtin_clzll(free_ranks[word])];
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void save(checkpoint_writer &out) const override {
+        out.put_vector(partitions);
+    }
+
+    bool load(checkpoint_reader &in) override {
+        std::vector<memory_partition> saved;
+        if (!in.get_vector(saved) || saved.size() != partitions.size()) {
+            return false;
+        }
+        for (std::size_t i = 0; i < partitions.size(); i++) {
+            if (saved[i].size != partitions[i].size) {
+                return false;
+            }
+            partitions[i].occupied = saved[i].occupied;
+            set_free(rank_of[i], saved[i].occupied == -1);
+        }
+        return true;
+    }
+
+private:
+    void set_free(std::size_t rank, bool free) {
+        if (free) {
+            free_ranks[rank / 64] |= 1ULL << (rank % 64);
+        } else {
+            free_ranks[rank / 64] &= ~(1ULL << (rank % 64));
+        }
+    }
+
+    //First free rank at or after rank, or partitions.size() if there is none
+    std::size_t first_free(std::size_t rank) const {
+        std::size_t word = rank / 64;
+        if (word >= free_ranks.size()) {
+            return partitions.size();
+        }
+        std::uint64_t bits = free_ranks[word] & (~0ULL << (rank % 64));
+        while (bits == 0) {
+            if (++word == free_ranks.size()) {
+                return partitions.size();
+            }
+            bits = free_ranks[word];
+        }
+        return word * 64 + __builtin_ctzll(bits);
+    }
+
+    std::vector<memory_partition>   partitions;
+    std::vector<std::size_t>        by_rank;        //Partition indices, most preferred fit first
+    std::vector<unsigned int>       rank_sizes;     //Size of the partition at each rank, ascending
+    std::vector<std::size_t>        rank_of;        //Partition index -> rank
+    std::vector<std::uint64_t>      free_ranks;     //Bit per rank, set while that partition is free
+};
+
+enum fit_policy {
+    FIRST_FIT,
+    BEST_FIT,
+    NEXT_FIT
+};
+
+//Variable partitioning: blocks are carved out of one region on demand. Holes are kept by address (first-fit,
+//next-fit and coalescing) and by size (best-fit), and a freed block merges with any free neighbour.
+//partition_number holds the start address of the block; jobs of size 0 still take 1MB. The tree nodes come
+//from a pool owned by the allocator, so once it has seen its busiest layout it stops calling malloc
+class variable_partition_allocator : public memory_allocator {
+public:
+    variable_partition_allocator(unsigned int total_size, fit_policy policy) : policy(policy), region(total_size) {
+        if (total_size > 0) {
+            add_hole(0, total_size);
+        }
+    }
+
+    bool assign(PCB &program) override {
+        unsigned int need = std::max(program.size, 1u);
+        auto hole = find_hole(need);
+        if (hole == holes.end()) {
+            return false;
+        }
+        unsigned int start = hole->first;
+        unsigned int size = hole->second;
+        remove_hole(hole);
+        if (size > need) {
+            add_hole(start + need, size - need);
+        }
+
+        used[start] = {need, program.PID};
+        rover = start + need;
+        program.partition_number = start;
+        return true;
+    }
+
+    bool release(PCB &program) override {
+        auto block = used.find(program.partition_number);
+        if (program.partition_number < 0 || block == used.end() || block->second.second != program.PID) {
+            return false;
+        }
+        unsigned int start = block->first;
+        unsigned int size = block->second.first;
+        used.erase(block);
+
+        //Coalesce with the hole right after and right before the block
+        auto next = holes.find(start + size);
+        if (next != holes.end()) {
+            size += next->second;
+            remove_hole(next);
+        }
+        auto after = holes.lower_bound(start);
+        if (after != holes.begin()) {
+            auto before = std::prev(after);
+            if (before->first + before->second == start) {
+                start = before->first;
+                size += before->second;
+                remove_hole(before);
+            }
+        }
+        add_hole(start, size);
+
+        program.partition_number = -1;
+        return true;
+    }
+
+    void layout(std::vector<memory_partition> &blocks) const override {
+        blocks.clear();
+        auto hole = holes.begin();
+        auto block = used.begin();
+        while (hole != holes.end() || block != used.end()) {
+            unsigned int number = blocks.size() + 1;
+            if (block == used.end() || (hole != holes.end() && hole->first < block->first)) {
+                blocks.push_back({number, hole->second, -1});
+                ++hole;
+            } else {
+                blocks.push_back({number, block->second.first, block->second.second});
+                ++block;
+            }
+        }
+    }
+
+    bool largest_free(unsigned int &size) const override {
+        if (holes_by_size.empty()) {
+            return false;
+        }
+        size = holes_by_size.rbegin()->first;
+        return true;
+    }
+
+    //Every block takes at least 1 MB, so there are never more used blocks than MB in the region, and never
+    //more holes than used blocks plus one. Nodes freed by the spare trees stay in the pool for the real ones
+    void reserve(std::size_t programs) override {
+        std::size_t nodes = std::min<std::size_t>(programs, region) + 1;
+        std::pmr::map<unsigned int, unsigned int> spare_holes{&pool};
+        std::pmr::set<std::pair<unsigned int, unsigned int>> spare_sizes{&pool};
+        std::pmr::map<unsigned int, std::pair<unsigned int, int>> spare_used{&pool};
+        for (unsigned int i = 0; i < nodes; i++) {
+            spare_holes[i] = 0;
+            spare_sizes.insert({0, i});
+            spare_used[i] = {0, -1};
+        }
+    }
+
+    //Blocks are saved as (start, size, PID or -1 for a hole)
+    void save(checkpoint_writer &out) const override {
+        std::vector<memory_partition> saved;
+        for (const auto &hole : holes) {
+            saved.push_back({hole.first, hole.second, -1});
+        }
+        for (const auto &block : used) {
+            saved.push_back({block.first, block.second.first, block.second.second});
+        }
+        out.put(rover);
+        out.put_vector(saved);
+    }
+
+    bool load(checkpoint_reader &in) override {
+        std::vector<memory_partition> saved;
+        if (!in.get(rover) || !in.get_vector(saved)) {
+            return false;
+        }
+        holes.clear();
+        holes_by_size.clear();
+        used.clear();
+        for (const auto &block : saved) {
+            if (block.occupied == -1) {
+                add_hole(block.partition_number, block.size);
+            } else {
+                used[block.partition_number] = {block.size, block.occupied};
+            }
+        }
+        return true;
+    }
+
+private:
+    std::pmr::map<unsigned int, unsigned int>::iterator find_hole(unsigned int need) {
+        if (policy == BEST_FIT) {
+            auto fit = holes_by_size.lower_bound({need, 0});
+            return (fit == holes_by_size.end()) ? holes.end() : holes.find(fit->second);
+        }
+
+        //First-fit scans from the lowest address, next-fit from where the last allocation ended
+        auto from = (policy == NEXT_FIT) ? holes.lower_bound(rover) : holes.begin();
+        for (auto hole = from; hole != holes.end(); ++hole) {
+            if (hole->second >= need) {
+                return hole;
+            }
+        }
+        for (auto hole = holes.begin(); hole != from; ++hole) {
+            if (hole->second >= need) {
+                return hole;
+            }
+        }
+        return holes.end();
+    }
+
+    void add_hole(unsigned int start, unsigned int size) {
+        holes[start] = size;
+        holes_by_size.insert({size, start});
+    }
+
+    void remove_hole(std::pmr::map<unsigned int, unsigned int>::iterator hole) {
+        holes_by_size.erase({hole->second, hole->first});
+        holes.erase(hole);
+    }
+
+    fit_policy                                              policy;
+    unsigned int                                            region;     //MB managed
+    unsigned int                                            rover = 0;  //Next-fit resumes searching here
+    std::pmr::unsynchronized_pool_resource                  pool;
+    std::pmr::map<unsigned int, unsigned int>               holes{&pool};           //start -> size
+    std::pmr::set<std::pair<unsigned int, unsigned int>>    holes_by_size{&pool};
+    std::pmr::map<unsigned int, std::pair<unsigned int, int>> used{&pool};          //start -> (size, PID)
+};
+
+//Binary buddy system. The tree spans the region rounded up to a power of two, but the blocks past the end of
+//the region are reserved for good, so capacity is exactly the region. Requests are rounded up to a power of two,
+//larger free blocks are split on demand and a freed block merges with its buddy while the buddy is free.
+//partition_number holds the start address of the block. Like the variable allocator, the tree nodes come
+//from a pool owned by the allocator
+class buddy_allocator : public memory_allocator {
+public:
+    explicit buddy_allocator(unsigned int total_size) {
+        while ((1ull << max_order) < total_size) {
+            max_order++;
+        }
+        free_lists.reserve(max_order + 1);
+        for (unsigned int order = 0; order <= max_order; order++) {
+            free_lists.emplace_back(&pool);
+        }
+
+        //Cut [0, 2^max_order) into the largest aligned blocks that lie wholly inside or wholly past the region
+        unsigned long long end = 1ull << max_order;
+        unsigned long long start = 0;
+        while (start < end) {
+            unsigned int order = (start == 0) ? max_order : __builtin_ctzll(start);
+            while (start < total_size && start + (1ull << order) > total_size) {
+                order--;
+            }
+            if (start < total_size) {
+                free_lists[order].insert(start);
+                blocks[start] = {order, -1};
+            } else {
+                blocks[start] = {order, RESERVED};
+            }
+            start += 1ull << order;
+        }
+    }
+
+    bool assign(PCB &program) override {
+        unsigned int order = 0;
+        while ((1ull << order) < program.size) {
+            order++;
+        }
+        if (order > max_order) {
+            return false;
+        }
+
+        unsigned int from = order;
+        while (from <= max_order && free_lists[from].empty()) {
+            from++;
+        }
+        if (from > max_order) {
+            return false;
+        }
+
+        unsigned int start = *free_lists[from].begin();
+        free_lists[from].erase(free_lists[from].begin());
+        while (from > order) {
+            from--;
+            unsigned int buddy = start + (1u << from);
+            free_lists[from].insert(buddy);
+            blocks[buddy] = {from, -1};
+        }
+
+        blocks[start] = {order, program.PID};
+        program.partition_number = start;
+        return true;
+    }
+
+    bool release(PCB &program) override {
+        auto block = blocks.find(program.partition_number);
+        if (program.partition_number < 0 || block == blocks.end() || block->second.second != program.PID
+            || block->second.second == RESERVED) {
+            return false;
+        }
+        unsigned int start = block->first;
+        unsigned int order = block->second.first;
+
+        while (order < max_order) {
+            unsigned int buddy = start ^ (1u << order);
+            if (free_lists[order].erase(buddy) == 0) {
+                break;
+            }
+            blocks.erase(std::max(start, buddy));
+            start = std::min(start, buddy);
+            order++;
+        }
+        free_lists[order].insert(start);
+        blocks[start] = {order, -1};
+
+        program.partition_number = -1;
+        return true;
+    }
+
+    //Reserved blocks all lie past the region, so leaving them out keeps the numbering of the rest
+    void layout(std::vector<memory_partition> &out) const override {
+        out.clear();
+        for (const auto &block : blocks) {
+            if (block.second.second != RESERVED) {
+                out.push_back({(unsigned int)(out.size() + 1), 1u << block.second.first, block.second.second});
+            }
+        }
+    }
+
+    bool largest_free(unsigned int &size) const override {
+        for (unsigned int order = max_order + 1; order-- > 0;) {
+            if (!free_lists[order].empty()) {
+                size = 1u << order;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    //An allocation splits at most one block per order, so each one adds at most max_order + 1 blocks, and
+    //there are never more blocks than MB in the tree. Nodes freed by the spare trees stay in the pool
+    void reserve(std::size_t programs) override {
+        std::size_t nodes = std::min<std::size_t>(programs * (max_order + 1), 1ull << max_order) + blocks.size();
+        std::pmr::map<unsigned int, std::pair<unsigned int, int>> spare_blocks{&pool};
+        std::pmr::set<unsigned int> spare_free{&pool};
+        for (unsigned int i = 0; i < nodes; i++) {
+            spare_blocks[i] = {0, -1};
+            spare_free.insert(i);
+        }
+    }
+
+    //Blocks are saved as (start, order, PID, -1 for a free block or RESERVED)
+    void save(checkpoint_writer &out) const override {
+        std::vector<memory_partition> saved;
+        for (const auto &block : blocks) {
+            saved.push_back({block.first, block.second.first, block.second.second});
+        }
+        out.put_vector(saved);
+    }
+
+    bool load(checkpoint_reader &in) override {
+        std::vector<memory_partition> saved;
+        if (!in.get_vector(saved)) {
+            return false;
+        }
+        for (auto &free_list : free_lists) {
+            free_list.clear();
+        }
+        blocks.clear();
+        for (const auto &block : saved) {
+            if (block.size > max_order) {
+                return false;
+            }
+            blocks[block.partition_number] = {block.size, block.occupied};
+            if (block.occupied == -1) {
+                free_lists[block.size].insert(block.partition_number);
+            }
+        }
+        return true;
+    }
+
+private:
+    static constexpr int                                        RESERVED = INT_MIN;     //Owner of the blocks past the region
+
+    unsigned int                                                max_order = 0;
+    std::pmr::unsynchronized_pool_resource                      pool;
+    std::vector<std::pmr::set<unsigned int>>                    free_lists;         //Free block starts per order
+    std::pmr::map<unsigned int, std::pair<unsigned int, int>>   blocks{&pool};      //start -> (order, PID), free and used
+};
+
+//Which of the jobs waiting for memory gets admitted when memory frees up
+enum admission_policy {
+    ADMIT_FIFO,             //Input order, and jobs that fit overtake the ones that do not (backfilling)
+    ADMIT_BEST_FIT,         //The largest job that fits the largest free block, filling it most tightly
+    ADMIT_LARGEST_FIRST     //The largest job, and nothing else until it fits, so large jobs cannot starve
+};
+
+const char* admission_names[] = {"fifo", "best-fit", "largest-first"};
+
+//Which blocked process is swapped out to make room for a job waiting for memory. Only processes at least as
+//large as that job are candidates: freeing one of them always makes room with every allocator, so nothing is
+//ever swapped out in vain
+enum swap_policy {
+    SWAP_NONE,          //Never swap; jobs wait until memory is freed
+    SWAP_LONGEST_IO,    //The one whose I/O completes last, so it would sit idle in memory the longest
+    SWAP_SMALLEST       //The smallest, so the least memory goes to and from the backing store
+};
+
+const char* swap_names[] = {"none", "longest-io", "smallest"};
+
+//Runtime memory configuration, filled in from the command line
+struct memory_config {
+    std::string                 allocator = "fixed";    //fixed, first-fit, best-fit, next-fit or buddy
+    std::vector<unsigned int>   partitions = {40, 25, 15, 10, 8, 2};
+    unsigned int                total_size = 0;         //Region for the dynamic allocators, 0 = sum of partitions
+    admission_policy            admission = ADMIT_FIFO;
+    swap_policy                 swap = SWAP_NONE;
+    unsigned int                swap_latency = 10;      //ms to bring a swapped out process back into memory
+};
+
+//Largest region an allocator accepts; addresses and sizes are unsigned int, and the buddy allocator's tree
+//must itself stay within 32 bits
+const unsigned long long MEMORY_MAX_SIZE = UINT_MAX;
+const unsigned long long BUDDY_MAX_SIZE = 1ull << 31;
+
+//Size of the region handed to the dynamic allocators: --memory-size, or the sum of the partitions
+unsigned long long memory_region_size(const memory_config &config) {
+    unsigned long long total_size = config.total_size;
+    if (total_size == 0) {
+        for (unsigned int size : config.partitions) {
+            total_size += size;
+        }
+    }
+    return total_size;
+}
+
+//Returns false and fills in error if the region is too large for the allocator config names
+bool check_memory_size(const memory_config &config, std::string &error) {
+    unsigned long long limit = (config.allocator == "buddy") ? BUDDY_MAX_SIZE : MEMORY_MAX_SIZE;
+    if (memory_region_size(config) > limit) {
+        error = "The " + config.allocator + " allocator supports at most " + std::to_string(limit) + " MB of memory";
+        return false;
+    }
+    return true;
+}
+
+//Builds the allocator described by config, or returns nullptr if the allocator name is unknown or the
+//region fails check_memory_size
+std::unique_ptr<memory_allocator> make_allocator(const memory_config &config) {
+    unsigned long long total_size = memory_region_size(config);
+    std::string error;
+    if (!check_memory_size(config, error)) {
+        return nullptr;
+    }
+
+    if (config.allocator == "fixed") {
+        return std::unique_ptr<memory_allocator>(new fixed_partition_allocator(config.partitions));
+    } else if (config.allocator == "first-fit") {
+        return std::unique_ptr<memory_allocator>(new variable_partition_allocator(total_size, FIRST_FIT));
+    } else if (config.allocator == "best-fit") {
+        return std::unique_ptr<memory_allocator>(new variable_partition_allocator(total_size, BEST_FIT));
+    } else if (config.allocator == "next-fit") {
+        return std::unique_ptr<memory_allocator>(new variable_partition_allocator(total_size, NEXT_FIT));
+    } else if (config.allocator == "buddy") {
+        return std::unique_ptr<memory_allocator>(new buddy_allocator(total_size));
+    }
+    return nullptr;
+}
+
+//Checks that every job fits the largest block of an empty memory; one that does not could never be
+//admitted and would leave the run unfinished. Returns false and fills in error otherwise
+bool check_job_sizes(const std::vector<PCB> &list_processes, const memory_allocator &empty_memory, std::string &error) {
+    unsigned int largest = 0;
+    empty_memory.largest_free(largest);
+    for (const auto &process : list_processes) {
+        if (process.size > largest) {
+            error = "PID " + std::to_string(process.PID) + " needs " + std::to_string(process.size)
+                    + " MB but no block of memory is larger than " + std::to_string(largest) + " MB";
+            return false;
+        }
+    }
+    return true;
+}
+
+//------------------------------------COMMAND LINE OPTIONS----------------------------------------------
+
+const unsigned int TIME_QUANTUM = 100;
+
+//Upper bound for the number of MLFQ levels, which are tracked in a bitmask
+const std::size_t MLFQ_MAX_LEVELS = 32;
+
+//Upper bound for --cpus; CPU numbers have to fit a byte of a binary trace record
+const unsigned int MAX_CPUS = 255;
+
+//Processors of the simulated machine. Each CPU has its own run queue; an idle CPU whose queue is empty
+//steals the next process from the longest other queue
+struct cpu_config {
+    unsigned int    cpus = 1;
+    bool            affinity = true;    //Processes woken from I/O return to the queue of the CPU they last ran on
+};
+
+//Checkpointing of a single run. A checkpoint is written every `every` seconds of wall time while the run
+//lasts; --resume continues from one and finishes with the same output an uninterrupted run would have
+struct checkpoint_config {
+    std::string     file;               //Where to write checkpoints, empty for none
+    unsigned int    every = 60;         //Seconds between checkpoints
+    std::string     resume;             //Checkpoint to continue from, empty to start from the beginning
+    std::string     key;                //Describes the run; a checkpoint only resumes a run with the same key
+};
+
+//Options shared by every scheduler binary, given after the input file
+struct run_options {
+    std::string     policy;             //EP, RR, EP_RR, MLFQ, SJF, SRTF, STRIDE or LOTTERY
+    unsigned int    quantum = TIME_QUANTUM;
+    memory_config   memory;
+    cpu_config      cpu;
+    std::string     trace = "text";     //text (execution.txt + memory_status.txt), binary (trace.bin) or none
+    std::string     metrics;            //Empty for none, text (metrics.txt) or json (metrics.json)
+    std::string     output_dir = "output_files";
+    checkpoint_config checkpoint;
+    std::string     profile_trace;      //Chrome trace-event JSON of a profiling build, empty for none
+
+    //MLFQ only
+    std::vector<unsigned int> mlfq_quanta = {10, 20, 40, 80};   //Quantum of each level, top level first
+    unsigned int    mlfq_boost = 1000;  //ms between priority boosts, 0 = never
+
+    //LOTTERY only
+    unsigned long long lottery_seed = 1;
+
+    //Batch and sweep modes only
+    std::string     policies = "EP,RR,EP_RR";
+    unsigned int    jobs = 0;           //Worker threads, 0 = one per core
+
+    //Sweep mode only
+    std::string     quanta = "100";     //Comma separated values or start:end[:step] ranges
+    std::string     layouts;            //Partition layouts separated by '/', empty = --partitions
+    std::string     csv = "output_files/sweep.csv";
+};
+
+const char* RUN_OPTIONS_USAGE = "[--policy EP|RR|EP_RR|MLFQ|SJF|SRTF|STRIDE|LOTTERY] [--quantum <ms>] [--mlfq-quanta 10,20,40,80] [--mlfq-boost <ms>] [--lottery-seed <n>] [--memory fixed|first-fit|best-fit|next-fit|buddy] [--partitions 40,25,15,10,8,2] [--memory-size <MB>] [--admission fifo|best-fit|largest-first] [--swap none|longest-io|smallest] [--swap-latency <ms>] [--cpus <n>] [--affinity soft|none] [--trace text|binary|none] [--metrics text|json] [--output-dir <dir>] [--checkpoint <file>] [--checkpoint-every <seconds>] [--resume <file>] [--profile-trace <file.json>]";
+
+//Parses the options in argv[first..argc). Returns false on an unknown or malformed option
+bool parse_run_options(int argc, char** argv, int first, run_options &options) {
+    try {
+        for (int i = first; i < argc; i++) {
+            std::string option = argv[i];
+            if (i + 1 >= argc) {
+                return false;
+            }
+            std::string value = argv[++i];
+
+            if (option == "--policy") {
+                options.policy = value;
+            } else if (option == "--quantum" && std::stoul(value) > 0) {
+                options.quantum = std::stoul(value);
+            } else if (option == "--mlfq-quanta") {
+                options.mlfq_quanta.clear();
+                for (const auto &quantum : split_delim(value, ",")) {
+                    options.mlfq_quanta.push_back(std::stoul(quantum));
+                    if (options.mlfq_quanta.back() == 0 || options.mlfq_quanta.size() > MLFQ_MAX_LEVELS) {
+                        return false;
+                    }
+                }
+            } else if (option == "--mlfq-boost") {
+                options.mlfq_boost = std::stoul(value);
+            } else if (option == "--lottery-seed") {
+                options.lottery_seed = std::stoull(value);
+            } else if (option == "--memory") {
+                options.memory.allocator = value;
+            } else if (option == "--partitions") {
+                options.memory.partitions.clear();
+                for (const auto &size : split_delim(value, ",")) {
+                    options.memory.partitions.push_back(std::stoul(size));
+                }
+            } else if (option == "--memory-size" && std::stoull(value) <= UINT_MAX) {
+                options.memory.total_size = std::stoul(value);
+            } else if (option == "--admission" && (value == "fifo" || value == "best-fit" || value == "largest-first")) {
+                options.memory.admission = (value == "fifo") ? ADMIT_FIFO : (value == "best-fit") ? ADMIT_BEST_FIT : ADMIT_LARGEST_FIRST;
+            } else if (option == "--swap" && (value == "none" || value == "longest-io" || value == "smallest")) {
+                options.memory.swap = (value == "none") ? SWAP_NONE : (value == "longest-io") ? SWAP_LONGEST_IO : SWAP_SMALLEST;
+            } else if (option == "--swap-latency") {
+                options.memory.swap_latency = std::stoul(value);
+            } else if (option == "--cpus" && std::stoul(value) > 0 && std::stoul(value) <= MAX_CPUS) {
+                options.cpu.cpus = std::stoul(value);
+            } else if (option == "--affinity" && (value == "soft" || value == "none")) {
+                options.cpu.affinity = (value == "soft");
+            } else if (option == "--trace" && (value == "text" || value == "binary" || value == "none")) {
+                options.trace = value;
+            } else if (option == "--metrics" && (value == "text" || value == "json")) {
+                options.metrics = value;
+            } else if (option == "--output-dir") {
+                options.output_dir = value;
+            } else if (option == "--checkpoint") {
+                options.checkpoint.file = value;
+            } else if (option == "--checkpoint-every") {
+                options.checkpoint.every = std::stoul(value);
+            } else if (option == "--resume") {
+                options.checkpoint.resume = value;
+            } else if (option == "--profile-trace") {
+                options.profile_trace = value;
+            } else if (option == "--policies") {
+                options.policies = value;
+            } else if (option == "--jobs") {
+                options.jobs = std::stoul(value);
+            } else if (option == "--quanta") {
+                options.quanta = value;
+            } else if (option == "--layouts") {
+                options.layouts = value;
+            } else if (option == "--csv") {
+                options.csv = value;
+            } else {
+                return false;
+            }
+        }
+    } catch (const std::exception &) {
+        return false;
+    }
+    std::string error;
+    if (!check_memory_size(options.memory, error)) {
+        std::cerr << "Error: " << error << std::endl;
+        return false;
+    }
+    return true;
+}
+
+//Assign memory partition to program
+bool assign_memory(memory_allocator &memory, PCB &program) {
+    return memory.assign(program);
+}
+
+//Free a memory partition
+bool free_memory(memory_allocator &memory, PCB &program){
+    return memory.release(program);
+}
+
+//Builds a new, not yet admitted PCB
+PCB make_process(int PID, unsigned int size, unsigned int arrival_time, unsigned int processing_time, unsigned int io_freq, unsigned int io_duration,
+                 int priority, unsigned int tickets) {
+    PCB process;
+    process.PID = PID;
+    process.size = size;
+    process.arrival_time = arrival_time;
+    process.processing_time = processing_time;
+    process.remaining_time = processing_time;
+    process.io_freq = io_freq;
+    process.io_duration = io_duration;
+    process.start_time = -1;
+    process.partition_number = -1;
+    process.state = NOT_ASSIGNED;
+    process.priority = priority;
+    process.tickets = tickets;
+
+    return process;
+}
+
+//Convert a list of strings into a PCB
+PCB add_process(std::vector<std::string> tokens) {
+    int priority = tokens.size() > 6 ? std::stoi(tokens[6]) : std::stoi(tokens[0]);
+    unsigned int tickets = tokens.size() > 7 ? std::stoul(tokens[7]) : DEFAULT_TICKETS;
+    return make_process(std::stoi(tokens[0]), std::stoi(tokens[1]), std::stoi(tokens[2]),
+                        std::stoi(tokens[3]), std::stoi(tokens[4]), std::stoi(tokens[5]), priority, tickets);
+}
+
+//Returns true if all processes in the table have terminated
+bool all_process_terminated(const process_table &table) {
+    return table.live == 0;
+}
+
+//Terminates a given process
+void terminate_process(PCB &running, process_table &table, memory_allocator &memory) {
+    running.remaining_time = 0;
+    running.state = TERMINATED;
+    free_memory(memory, running);
+    sync_queue(table, running);
+}
+
+//set the process in the ready queue to runnning
+void run_process(PCB &running, process_table &table, std::size_t handle, unsigned int current_time) {
+    running = table.get(handle);
+    running.start_time = current_time;
+    running.state = RUNNING;
+    sync_queue(table, running);
+}
+
+void idle_CPU(PCB &running) {
+    running.start_time = 0;
+    running.processing_time = 0;
+    running.remaining_time = 0;
+    running.arrival_time = 0;
+    running.io_duration = 0;
+    running.io_freq = 0;
+    running.partition_number = 0;
+    running.size = 0;
+    running.state = NOT_ASSIGNED;
+    running.PID = -1;
+}
+
+//------------------------------------EVENT QUEUE FOR THE SIMULATOR------------------------------------
+//Instead of stepping the clock one unit at a time, the schedulers only wake up at ticks where
+//something can change: an arrival, an I/O completion, the running burst ending (I/O request or
+//termination), a quantum expiry, an idle CPU with work waiting to be dispatched, a swapped out process
+//back in memory, or a timer the policy asked for (the MLFQ priority boost).
+
+enum event_type {
+    ARRIVAL,
+    IO_COMPLETION,
+    BURST_END,
+    QUANTUM_EXPIRY,
+    DISPATCH,
+    POLICY_TIMER,
+    SWAP_COMPLETION
+};
+
+struct sim_event {
+    unsigned int    time;
+    event_type      type;
+    int             PID;
+};
+
+//Orders the event queue so the earliest event is on top
+struct later_event {
+    bool operator()(const sim_event &a, const sim_event &b) const {
+        return a.time > b.time;
+    }
+};
+
+//A priority queue whose storage can be reserved up front
+struct event_queue : std::priority_queue<sim_event, std::vector<sim_event>, later_event> {
+    void reserve(std::size_t n) {
+        c.reserve(n);
+    }
+
+    void save(checkpoint_writer &out) const {
+        out.put_vector(c);
+    }
+
+    bool load(checkpoint_reader &in) {
+        return in.get_vector(c);
+    }
+};
+
+void schedule_event(event_queue &events, unsigned int time, event_type type, int PID) {
+    events.push({time, type, PID});
+}
+
+//Schedules the next tick at which the running process needs attention.
+//slice_used is the number of units run in the current quantum; a quantum of 0 means no time slicing
+void schedule_running(event_queue &events, const PCB &running, unsigned int current_time, unsigned int slice_used, unsigned int quantum) {
+    unsigned int units = running.remaining_time;
+    if (running.io_freq > 0) {
+        unsigned int time_spent = running.processing_time - running.remaining_time;
+        units = std::min(units, running.io_freq - time_spent % running.io_freq);
+    }
+
+    if (quantum > 0) {
+        //The quantum is checked at the start of a tick, one tick after the last unit in the slice
+        unsigned int expiry = (slice_used >= quantum) ? 1 : quantum - slice_used + 1;
+        if (expiry <= units) {
+            schedule_event(events, current_time + expiry, QUANTUM_EXPIRY, running.PID);
+            return;
+        }
+    }
+    schedule_event(events, current_time + units, BURST_END, running.PID);
+}
+
+//Discards everything due at or before current_time and returns the time of the next pending event.
+//Returns false when there is nothing left to simulate
+bool next_event_time(event_queue &events, unsigned int current_time, unsigned int &next_time) {
+    while (!events.empty() && events.top().time <= current_time) {
+        events.pop();
+    }
+    if (events.empty()) {
+        return false;
+    }
+    next_time = events.top().time;
+    return true;
+}
+
+//Lets the running process execute through ticks in which nothing else happens
+void advance_running(PCB &running, unsigned int ticks) {
+    if (running.state == RUNNING) {
+        running.remaining_time -= ticks;
+    }
+}
+
+//------------------------------------ARRIVAL STREAM----------------------------------------------------
+//Jobs are ordered by arrival time once at startup and consumed through a cursor. Jobs that arrive
+//while memory is full wait in the pending index, bucketed by size class (one per distinct job size), and
+//are only looked at alongside new arrivals or after a partition has been freed. Given the largest free
+//block, a bitmask of the non-empty classes finds the jobs that fit without touching the ones that don't,
+//so a saturated memory costs nothing per waiting job. Each bucket is a min-heap of handles and yields its
+//jobs in input order. The stream only holds handles into the PCB pool, and every bucket is sized for its
+//jobs up front so admission never allocates.
+
+struct arrival_stream {
+    std::vector<std::size_t>    order;      //Handles sorted by arrival time, ties in input order
+    bool                        in_order;   //True if order is the identity, i.e. the trace was sorted
+    std::size_t                 cursor = 0; //Next entry of order that has not arrived yet
+
+    std::vector<unsigned int>               class_sizes;    //Distinct job sizes, ascending
+    std::vector<std::uint32_t>              size_class;     //Handle -> index into class_sizes
+    std::vector<std::vector<std::size_t>>   waiting;        //Per size class, min-heap of the handles waiting for memory
+    std::vector<std::uint64_t>              occupied;       //Bit per size class with a job waiting
+    std::size_t                             pending = 0;    //Jobs waiting for memory
+};
+
+arrival_stream make_arrival_stream(const std::vector<unsigned int> &arrival_times, const std::vector<unsigned int> &sizes) {
+    PROFILE_SCOPE(PHASE_SETUP);
+    arrival_stream stream;
+    stream.order.resize(arrival_times.size());
+    for (std::size_t i = 0; i < stream.order.size(); i++) {
+        stream.order[i] = i;
+    }
+
+    //Traces are usually written in arrival order already, in which case there is nothing to sort
+    stream.in_order = non_decreasing(arrival_times.data(), arrival_times.size());
+    if (!stream.in_order) {
+        std::stable_sort(stream.order.begin(), stream.order.end(), [&arrival_times](std::size_t a, std::size_t b) {
+            return arrival_times[a] < arrival_times[b];
+        });
+    }
+
+    stream.class_sizes = sizes;
+    std::sort(stream.class_sizes.begin(), stream.class_sizes.end());
+    stream.class_sizes.erase(std::unique(stream.class_sizes.begin(), stream.class_sizes.end()), stream.class_sizes.end());
+    std::vector<std::size_t> jobs_per_class(stream.class_sizes.size(), 0);
+    stream.size_class.resize(sizes.size());
+    for (std::size_t i = 0; i < sizes.size(); i++) {
+        stream.size_class[i] = std::lower_bound(stream.class_sizes.begin(), stream.class_sizes.end(), sizes[i]) - stream.class_sizes.begin();
+        jobs_per_class[stream.size_class[i]]++;
+    }
+    stream.waiting.resize(stream.class_sizes.size());
+    for (std::size_t c = 0; c < stream.waiting.size(); c++) {
+        stream.waiting[c].reserve(jobs_per_class[c]);
+    }
+    stream.occupied.assign((stream.class_sizes.size() + 63) / 64, 0);
+    return stream;
+}
+
+//Returns true once every job has been admitted
+bool arrivals_done(const arrival_stream &stream) {
+    return stream.cursor == stream.order.size() && stream.pending == 0;
+}
+
+//Returns true if a job that has not been seen yet arrives at or before current_time
+bool arrival_due(const arrival_stream &stream, const std::vector<unsigned int> &arrival_times, unsigned int current_time) {
+    return stream.cursor < stream.order.size() && arrival_times[stream.order[stream.cursor]] <= current_time;
+}
+
+//Adds an arrived job to the pending index
+void wait_for_memory(arrival_stream &stream, std::size_t handle) {
+    std::uint32_t c = stream.size_class[handle];
+    stream.waiting[c].push_back(handle);
+    std::push_heap(stream.waiting[c].begin(), stream.waiting[c].end(), std::greater<std::size_t>());
+    stream.occupied[c / 64] |= 1ULL << (c % 64);
+    stream.pending++;
+}
+
+//Takes every job arriving by current_time off the stream and adds it to the pending index
+void take_arrivals(arrival_stream &stream, const std::vector<unsigned int> &arrival_times, unsigned int current_time) {
+    std::size_t first = stream.cursor;
+    if (stream.in_order) {
+        //The unseen jobs are a contiguous run of the arrival column
+        stream.cursor += prefix_not_after(arrival_times.data() + first, arrival_times.size() - first, current_time);
+    } else {
+        while (arrival_due(stream, arrival_times, current_time)) {
+            stream.cursor++;
+        }
+    }
+    for (std::size_t i = first; i < stream.cursor; i++) {
+        wait_for_memory(stream, stream.order[i]);
+    }
+}
+
+//Highest non-empty size class below limit, or limit if there is none
+std::size_t highest_waiting_class(const arrival_stream &stream, std::size_t limit) {
+    for (std::size_t word = (limit + 63) / 64; word-- > 0;) {
+        std::uint64_t bits = stream.occupied[word];
+        if (word == limit / 64) {
+            bits &= (1ULL << (limit % 64)) - 1;
+        }
+        if (bits != 0) {
+            return word * 64 + 63 - __builtin_clzll(bits);
+        }
+    }
+    return limit;
+}
+
+//Non-empty size class below limit whose first job comes first in input order, or limit if there is none
+std::size_t earliest_waiting_class(const arrival_stream &stream, std::size_t limit) {
+    std::size_t best = limit;
+    for (std::size_t word = 0; word * 64 < limit; word++) {
+        std::uint64_t bits = stream.occupied[word];
+        if (word == limit / 64) {
+            bits &= (1ULL << (limit % 64)) - 1;
+        }
+        for (; bits != 0; bits &= bits - 1) {
+            std::size_t c = word * 64 + __builtin_ctzll(bits);
+            if (best == limit || stream.waiting[c].front() < stream.waiting[best].front()) {
+                best = c;
+            }
+        }
+    }
+    return best;
+}
+
+//Size class of the job policy admits next given the largest free block, or class_sizes.size() if it admits
+//nothing for now
+std::size_t admission_class(const arrival_stream &stream, admission_policy policy, unsigned int largest_free) {
+    std::size_t none = stream.class_sizes.size();
+    if (stream.pending == 0) {
+        return none;
+    }
+    //Size classes below fitting hold the jobs that fit
+    std::size_t fitting = std::upper_bound(stream.class_sizes.begin(), stream.class_sizes.end(), largest_free) - stream.class_sizes.begin();
+    std::size_t c;
+    if (policy == ADMIT_FIFO) {
+        c = earliest_waiting_class(stream, fitting);
+    } else if (policy == ADMIT_BEST_FIT) {
+        c = highest_waiting_class(stream, fitting);
+    } else {
+        c = highest_waiting_class(stream, none);
+    }
+    return (c < fitting) ? c : none;
+}
+
+//Size of the job policy would admit next if memory were no object. Returns false if nothing is pending
+bool next_admission_size(const arrival_stream &stream, admission_policy policy, unsigned int &size) {
+    std::size_t c = admission_class(stream, policy, UINT_MAX);
+    if (c == stream.class_sizes.size()) {
+        return false;
+    }
+    size = stream.class_sizes[c];
+    return true;
+}
+
+//Picks the next job to admit under policy, given the largest free block, and takes it off the pending
+//index. Returns false if the policy admits nothing more for now
+bool take_admission(arrival_stream &stream, admission_policy policy, unsigned int largest_free, std::size_t &handle) {
+    std::size_t c = admission_class(stream, policy, largest_free);
+    if (c == stream.class_sizes.size()) {
+        return false;
+    }
+
+    std::pop_heap(stream.waiting[c].begin(), stream.waiting[c].end(), std::greater<std::size_t>());
+    handle = stream.waiting[c].back();
+    stream.waiting[c].pop_back();
+    if (stream.waiting[c].empty()) {
+        stream.occupied[c / 64] &= ~(1ULL << (c % 64));
+    }
+    stream.pending--;
+    return true;
+}
+
+//The jobs waiting for memory, for checkpoints; the heap layout itself does not matter since every bucket
+//pops in handle order
+std::vector<std::size_t> pending_jobs(const arrival_stream &stream) {
+    std::vector<std::size_t> jobs;
+    for (const auto &bucket : stream.waiting) {
+        jobs.insert(jobs.end(), bucket.begin(), bucket.end());
+    }
+    return jobs;
+}
+
+//Schedules the arrival of the next job that has not been seen yet
+void schedule_next_arrival(event_queue &events, const arrival_stream &stream, const process_table &table) {
+    if (stream.cursor < stream.order.size()) {
+        std::size_t next = stream.order[stream.cursor];
+        schedule_event(events, table.arrival_time[next], ARRIVAL, table.PID[next]);
+    }
+}
+
+//This was implemented for the bonus
+//I could have implemented inside of each indivudal cpp file but decided this was the best and most simple course
+//of action since I could reference it directly inside all the others files
+
+std::string get_memory_status(const memory_allocator &memory, unsigned int current_time) {
+    std::vector<memory_partition> blocks;
+    memory.layout(blocks);
+
+    std::stringstream ss;
+    unsigned int total_used_mem = 0;
+    unsigned int total_free_mem = 0;
+
+    ss << "Time: " << current_time << "\n"
+       << "Partition Status:\n";
+
+    for (const auto& part : blocks) {
+        ss << "  Part " << part.partition_number 
+           << " [" << part.size << "MB]: ";
+        
+        if (part.occupied != -1) {
+            ss << "Occupied by PID " << part.occupied;
+            total_used_mem += part.size;
+        } else {
+            ss << "Free";
+            total_free_mem += part.size;
+        }
+        ss << "\n";
+    }
+
+    ss << "Stats:\n"
+       << "  Total Memory Used: " << total_used_mem << " MB\n"
+       << "  Total Free Memory: " << total_free_mem << " MB\n"
+       << "--------------------------------------------------\n";
 
     return ss.str();
 }
 
+//Streaming equivalent of get_memory_status for a given list of blocks
+void write_memory_status(trace_writer &out, const std::vector<memory_partition> &blocks, unsigned int current_time) {
+    unsigned int total_used_mem = 0;
+    unsigned int total_free_mem = 0;
+
+    out.write("Time: ");
+    out.write_int(current_time);
+    out.write("\nPartition Status:\n");
+
+    for (const auto& part : blocks) {
+        out.write("  Part ");
+        out.write_int(part.partition_number);
+        out.write(" [");
+        out.write_int(part.size);
+        out.write("MB]: ");
+
+        if (part.occupied != -1) {
+            out.write("Occupied by PID ");
+            out.write_int(part.occupied);
+            total_used_mem += part.size;
+        } else {
+            out.write("Free");
+            total_free_mem += part.size;
+        }
+        out.write('\n');
+    }
+
+    out.write("Stats:\n  Total Memory Used: ");
+    out.write_int(total_used_mem);
+    out.write(" MB\n  Total Free Memory: ");
+    out.write_int(total_free_mem);
+    out.write(" MB\n--------------------------------------------------\n");
+}
+
+void write_memory_status(trace_writer &out, const memory_allocator &memory, unsigned int current_time) {
+    std::vector<memory_partition> blocks;
+    memory.layout(blocks);
+    write_memory_status(out, blocks, current_time);
+}
+
 #endif
\ No newline at end of file
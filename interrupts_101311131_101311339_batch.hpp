@@ -0,0 +1,191 @@
+/**
+ * @file interrupts_101311131_101311339_batch.hpp
+ * @author Sasisekhar Govind, Yuvraj Bains, James Bian
+ * @brief Batch mode: simulates every (trace, policy) pair of a suite on a pool of worker threads
+ *
+ */
+
+#ifndef INTERRUPTS_BATCH_HPP_
+#define INTERRUPTS_BATCH_HPP_
+
+#include "interrupts_101311131_101311339_engine.hpp"
+#include<algorithm>
+#include<atomic>
+#include<filesystem>
+#include<fstream>
+#include<set>
+#include<thread>
+
+//------------------------------------BATCH RUNNER------------------------------------------------------
+//Every run is isolated: it loads its own copy of the trace, builds its own allocator and writes to its
+//own <output_dir>/<policy>/<trace name>/ directory, so the runs share nothing and need no locking.
+
+struct batch_job {
+    std::string     trace_file;
+    std::string     policy;
+    std::string     output_dir;
+    std::string     error;              //Empty if the run succeeded
+};
+
+//Collects the traces to run: every *.txt file of a directory in name order, a single *.txt trace, or the
+//paths listed one per line in any other (manifest) file. Returns false and fills in error if source cannot
+//be read
+bool collect_traces(const std::string &source, std::vector<std::string> &traces, std::string &error) {
+    std::error_code ec;
+    if (std::filesystem::path(source).extension() == ".txt") {
+        traces.push_back(source);
+    } else if (std::filesystem::is_directory(source, ec)) {
+        for (const auto &entry : std::filesystem::directory_iterator(source, ec)) {
+            if (entry.is_regular_file() && entry.path().extension() == ".txt") {
+                traces.push_back(entry.path().string());
+            }
+        }
+        std::sort(traces.begin(), traces.end());
+    } else {
+        std::ifstream manifest(source);
+        if (!manifest.is_open()) {
+            error = "Unable to open trace directory or manifest: " + source;
+            return false;
+        }
+        std::string line;
+        while (std::getline(manifest, line)) {
+            line.erase(0, line.find_first_not_of(" \t\r"));
+            line.erase(line.find_last_not_of(" \t\r") + 1);
+            if (!line.empty() && line[0] != '#') {
+                traces.push_back(line);
+            }
+        }
+    }
+
+    if (ec) {
+        error = "Unable to read " + source + ": " + ec.message();
+        return false;
+    }
+    if (traces.empty()) {
+        error = "No traces found in " + source;
+        return false;
+    }
+    return true;
+}
+
+//Runs one job start to finish, recording any failure in job.error
+void run_batch_job(batch_job &job, const run_options &options) {
+    std::unique_ptr<memory_allocator> memory = make_allocator(options.memory);
+    if (!memory) {
+        job.error = "Unknown memory allocator: " + options.memory.allocator;
+        return;
+    }
+
+    std::vector<PCB> list_process;
+    if (!load_processes(job.trace_file.c_str(), list_process, job.error) || !check_job_sizes(list_process, *memory, job.error)) {
+        return;
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(job.output_dir, ec);
+    if (ec) {
+        job.error = "Unable to create " + job.output_dir + ": " + ec.message();
+        return;
+    }
+
+    std::string error;
+    if (!simulate_to_directory(options, job.policy, job.output_dir, std::move(list_process), *memory, error)) {
+        job.error = error.empty() ? "Unable to write output files in " + job.output_dir : error;
+    }
+}
+
+//Calls run(i) for every i in [0, count) on the given number of threads. Workers claim the next unstarted
+//index until none are left, so long runs do not hold up the rest of the pool
+template <typename Run>
+void run_parallel(std::size_t count, unsigned int threads, Run run) {
+    std::atomic<std::size_t> next(0);
+    auto worker = [&]() {
+        for (std::size_t i = next++; i < count; i = next++) {
+            run(i);
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (unsigned int i = 1; i < threads; i++) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (auto &thread : pool) {
+        thread.join();
+    }
+}
+
+//Number of worker threads to use for count runs when requested threads were asked for (0 = one per core)
+unsigned int worker_threads(unsigned int requested, std::size_t count) {
+    unsigned int threads = requested;
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    return std::max<std::size_t>(1, std::min<std::size_t>(threads, count));
+}
+
+//Entry point for "bin/interrupts --batch <directory|trace|manifest> [options]". Returns the process exit code
+int batch_main(int argc, char** argv) {
+
+    run_options options;
+    options.output_dir = "output_files/batch";
+    if(argc < 3 || !parse_run_options(argc, argv, 3, options)) {
+        std::cout << "Usage: " << argv[0] << " --batch <input_directory|trace|manifest> [--policies EP,RR,EP_RR,MLFQ,SJF,SRTF,STRIDE,LOTTERY] [--jobs <threads>] "
+                  << RUN_OPTIONS_USAGE << std::endl;
+        return -1;
+    }
+
+    if (!options.checkpoint.file.empty() || !options.checkpoint.resume.empty() || !options.profile_trace.empty()) {
+        std::cerr << "Error: --checkpoint, --resume and --profile-trace only apply to single runs" << std::endl;
+        return -1;
+    }
+    std::vector<std::string> policies = split_delim(options.policies, ",");
+    for (const auto &policy : policies) {
+        if (!known_policy(policy)) {
+            std::cerr << "Error: Unknown policy: " << policy << std::endl;
+            return -1;
+        }
+    }
+
+    std::vector<std::string> traces;
+    std::string error;
+    if (!collect_traces(argv[2], traces, error)) {
+        std::cerr << "Error: " << error << std::endl;
+        return -1;
+    }
+
+    //Traces are named by file stem; a manifest may list two files with the same stem from different
+    //directories, and the later ones get -2, -3... so no two runs write into the same directory
+    std::vector<batch_job> jobs;
+    std::set<std::string> names;
+    for (const auto &trace_file : traces) {
+        std::string stem = std::filesystem::path(trace_file).stem().string();
+        std::string name = stem;
+        for (unsigned int copy = 2; !names.insert(name).second; copy++) {
+            name = stem + "-" + std::to_string(copy);
+        }
+        for (const auto &policy : policies) {
+            jobs.push_back({trace_file, policy, options.output_dir + "/" + policy + "/" + name, ""});
+        }
+    }
+
+    unsigned int threads = worker_threads(options.jobs, jobs.size());
+    run_parallel(jobs.size(), threads, [&](std::size_t i) {
+        run_batch_job(jobs[i], options);
+    });
+
+    int failed = 0;
+    for (const auto &job : jobs) {
+        if (job.error.empty()) {
+            std::cout << job.policy << " " << job.trace_file << ": " << output_files(options, job.output_dir) << std::endl;
+        } else {
+            std::cerr << "Error: " << job.policy << " " << job.trace_file << ": " << job.error << std::endl;
+            failed++;
+        }
+    }
+    std::cout << jobs.size() - failed << " of " << jobs.size() << " runs completed on " << threads << " threads" << std::endl;
+
+    return failed == 0 ? 0 : -1;
+}
+
+#endif
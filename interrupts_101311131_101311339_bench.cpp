@@ -0,0 +1,633 @@
+/**
+ * @file interrupts_101311131_101311339_bench.cpp
+ * @author Sasisekhar Govind, Yuvraj Bains, James Bian
+ * @brief Micro and end-to-end benchmarks for the simulator hot paths, with a stored baseline to catch regressions
+ */
+
+#include "interrupts_101311131_101311339_engine.hpp"
+#include "interrupts_101311131_101311339_generate.hpp"
+#include<chrono>
+#include<cstdlib>
+#include<functional>
+#include<new>
+
+//Every heap allocation in the process goes through here, so --allocations can count them
+std::size_t allocation_count = 0;
+
+//GCC sees free() called on memory it knows came from operator new and flags the pair, but here both
+//sides are these malloc based replacements
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+
+void* operator new(std::size_t size) {
+    allocation_count++;
+    if (void* block = std::malloc(size > 0 ? size : 1)) {
+        return block;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* block) noexcept {
+    std::free(block);
+}
+
+void operator delete(void* block, std::size_t) noexcept {
+    std::free(block);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    allocation_count++;
+    std::size_t align = static_cast<std::size_t>(alignment);
+    if (void* block = std::aligned_alloc(align, (std::max<std::size_t>(size, 1) + align - 1) / align * align)) {
+        return block;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* block, std::align_val_t) noexcept {
+    std::free(block);
+}
+
+void operator delete(void* block, std::size_t, std::align_val_t) noexcept {
+    std::free(block);
+}
+
+#pragma GCC diagnostic pop
+
+//------------------------------------BENCHMARK HARNESS-------------------------------------------------
+//Each benchmark runs a body for a requested number of iterations and returns how many items (events,
+//allocations, rows...) it processed. The harness grows the iteration count until one timed run takes at
+//least the minimum time, then reports time per iteration and items per second.
+
+struct benchmark {
+    std::string                                     name;
+    std::function<std::size_t(std::size_t)>         run;
+};
+
+struct benchmark_result {
+    std::string     name;
+    double          ns_per_iteration;
+    double          items_per_second;
+};
+
+//Keeps the compiler from optimizing away a result
+template <typename T>
+void keep(const T &value) {
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+benchmark_result measure(const benchmark &bench, double min_seconds) {
+    std::size_t iterations = 1;
+    while (true) {
+        auto start = std::chrono::steady_clock::now();
+        std::size_t items = bench.run(iterations);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        if (seconds >= min_seconds || iterations >= (1ULL << 30)) {
+            return {bench.name, seconds * 1e9 / iterations, items / seconds};
+        }
+        //Jump close to the target once the timing is meaningful instead of doubling all the way
+        std::size_t scale = seconds > 0.01 ? (std::size_t)(1.2 * min_seconds / seconds) + 1 : 10;
+        iterations *= std::max<std::size_t>(2, std::min<std::size_t>(scale, 10));
+    }
+}
+
+//------------------------------------WORKLOADS---------------------------------------------------------
+
+//Generated jobs. By default arrivals are slow enough that memory does not saturate, so the simulation
+//benchmarks measure the engine rather than an ever-growing backlog of jobs waiting for a partition; the
+//admission benchmarks raise the rate to build exactly that backlog
+std::vector<PCB> bench_workload(unsigned long long processes, double io_bound, double arrival_rate = 0.01) {
+    workload_config config;
+    config.processes = processes;
+    config.seed = 42;
+    config.burst_max = 500;
+    config.arrival_rate = arrival_rate;
+    config.io_bound_fraction = io_bound;
+
+    workload_generator generator(config);
+    std::vector<PCB> jobs;
+    PCB process;
+    while (jobs.size() < processes && generator.next(process)) {
+        process.start_time = -1;
+        process.remaining_time = process.processing_time;
+        process.partition_number = -1;
+        process.state = NEW;
+        jobs.push_back(process);
+    }
+    return jobs;
+}
+
+//Counts transitions without writing anything, so only the engine is measured
+class counting_trace_sink : public trace_sink {
+public:
+    void transition(unsigned int, unsigned int, int, states, states) override {
+        events++;
+    }
+
+    void memory_snapshot(const memory_allocator &, unsigned int) override {
+        events++;
+    }
+
+    void finish() override {}
+
+    std::size_t events = 0;
+};
+
+//------------------------------------BENCHMARKS--------------------------------------------------------
+
+void add_simulation_benchmarks(std::vector<benchmark> &benchmarks) {
+    for (const char* policy : {"EP", "RR", "EP_RR", "MLFQ", "SJF", "SRTF", "STRIDE", "LOTTERY"}) {
+        for (unsigned long long processes : {1000ULL, 10000ULL, 100000ULL}) {
+            for (double io_bound : {0.0, 0.5}) {
+                std::string name = std::string("simulate/") + policy + "/" + std::to_string(processes) + "/io:" + (io_bound > 0 ? "50%" : "0%");
+                std::shared_ptr<std::vector<PCB>> jobs = std::make_shared<std::vector<PCB>>(bench_workload(processes, io_bound));
+                benchmarks.push_back({name, [=](std::size_t iterations) {
+                    std::size_t events = 0;
+                    for (std::size_t i = 0; i < iterations; i++) {
+                        std::unique_ptr<memory_allocator> memory = make_allocator(memory_config());
+                        counting_trace_sink trace;
+                        run_policy(policy, run_options(), *jobs, *memory, trace);
+                        events += trace.events;
+                    }
+                    return events;
+                }});
+            }
+        }
+    }
+
+    //The same saturated workload on a four CPU machine, with work stealing between the run queues
+    for (const char* policy : {"EP", "RR", "EP_RR"}) {
+        std::string name = std::string("simulate/") + policy + "/100000/io:50%/cpus:4";
+        std::shared_ptr<std::vector<PCB>> jobs = std::make_shared<std::vector<PCB>>(bench_workload(100000, 0.5));
+        benchmarks.push_back({name, [=](std::size_t iterations) {
+            run_options options;
+            options.cpu.cpus = 4;
+            std::size_t events = 0;
+            for (std::size_t i = 0; i < iterations; i++) {
+                std::unique_ptr<memory_allocator> memory = make_allocator(memory_config());
+                counting_trace_sink trace;
+                run_policy(policy, options, *jobs, *memory, trace);
+                events += trace.events;
+            }
+            return events;
+        }});
+    }
+}
+
+//Arrivals a hundred times faster than memory frees up, so thousands of jobs wait for a partition and every
+//termination runs the admission policy against the whole backlog. The swap runs also look for a victim
+//every time a process blocks
+void add_admission_benchmarks(std::vector<benchmark> &benchmarks) {
+    std::shared_ptr<std::vector<PCB>> jobs = std::make_shared<std::vector<PCB>>(bench_workload(20000, 0.5, 1.0));
+    for (admission_policy admission : {ADMIT_FIFO, ADMIT_BEST_FIT, ADMIT_LARGEST_FIRST}) {
+        benchmarks.push_back({std::string("admission/") + admission_names[admission] + "/20000/saturated", [=](std::size_t iterations) {
+            run_options options;
+            options.memory.admission = admission;
+            std::size_t events = 0;
+            for (std::size_t i = 0; i < iterations; i++) {
+                std::unique_ptr<memory_allocator> memory = make_allocator(options.memory);
+                counting_trace_sink trace;
+                run_policy("RR", options, *jobs, *memory, trace);
+                events += trace.events;
+            }
+            return events;
+        }});
+    }
+    for (swap_policy swap : {SWAP_LONGEST_IO, SWAP_SMALLEST}) {
+        benchmarks.push_back({std::string("swap/") + swap_names[swap] + "/20000/saturated", [=](std::size_t iterations) {
+            run_options options;
+            options.memory.swap = swap;
+            std::size_t events = 0;
+            for (std::size_t i = 0; i < iterations; i++) {
+                std::unique_ptr<memory_allocator> memory = make_allocator(options.memory);
+                counting_trace_sink trace;
+                run_policy("RR", options, *jobs, *memory, trace);
+                events += trace.events;
+            }
+            return events;
+        }});
+    }
+}
+
+//One iteration assigns every job once, releasing the oldest holders whenever memory is full
+void add_memory_benchmarks(std::vector<benchmark> &benchmarks) {
+    for (const char* allocator : {"fixed", "first-fit", "best-fit", "next-fit", "buddy"}) {
+        std::shared_ptr<std::vector<PCB>> jobs = std::make_shared<std::vector<PCB>>(bench_workload(1000, 0));
+        benchmarks.push_back({std::string("memory/assign_free/") + allocator, [=](std::size_t iterations) {
+            memory_config config;
+            config.allocator = allocator;
+            std::unique_ptr<memory_allocator> memory = make_allocator(config);
+            std::vector<PCB> held = *jobs;
+            std::size_t operations = 0;
+            for (std::size_t i = 0; i < iterations; i++) {
+                std::size_t oldest = 0;
+                for (std::size_t j = 0; j < held.size(); j++) {
+                    while (!assign_memory(*memory, held[j]) && oldest < j) {
+                        free_memory(*memory, held[oldest++]);
+                        operations++;
+                    }
+                    operations++;
+                }
+                for (; oldest < held.size(); oldest++) {
+                    free_memory(*memory, held[oldest]);
+                    operations++;
+                }
+            }
+            return operations;
+        }});
+    }
+}
+
+//The ready queue replaced sortByPriority: one iteration pushes n processes and pops them all
+void add_ready_queue_benchmarks(std::vector<benchmark> &benchmarks) {
+    for (std::size_t n : {100, 10000}) {
+        benchmarks.push_back({"ready_heap/push_pop/" + std::to_string(n), [=](std::size_t iterations) {
+            std::mt19937_64 random(7);
+            std::vector<int> keys(n);
+            for (auto &key : keys) {
+                key = random() % 1000;
+            }
+            ready_heap ready;
+            std::size_t total = 0;
+            for (std::size_t i = 0; i < iterations; i++) {
+                for (std::size_t h = 0; h < n; h++) {
+                    ready.push(h, keys[h]);
+                }
+                while (!ready.empty()) {
+                    total += ready.pop();
+                }
+            }
+            keep(total);
+            return iterations * n;
+        }});
+    }
+}
+
+void add_sync_queue_benchmarks(std::vector<benchmark> &benchmarks) {
+    for (std::size_t n : {100, 100000}) {
+        benchmarks.push_back({"sync_queue/" + std::to_string(n), [=](std::size_t iterations) {
+            std::vector<PCB> jobs = bench_workload(n, 0);
+            for (auto &job : jobs) {
+                job.state = READY;
+            }
+            process_table table = make_process_table(jobs);
+            for (std::size_t handle = 0; handle < jobs.size(); handle++) {
+                add_to_table(table, handle);
+            }
+            for (std::size_t i = 0; i < iterations; i++) {
+                for (auto &job : jobs) {
+                    job.remaining_time = i;
+                    sync_queue(table, job);
+                }
+            }
+            keep(table.remaining_time[0]);
+            return iterations * n;
+        }});
+    }
+}
+
+//Number of entries of values[0, n) equal to value
+std::size_t count_equal(const std::uint8_t* values, std::size_t n, std::uint8_t value) {
+    std::size_t count = 0;
+    std::size_t i = 0;
+#ifdef __SSE2__
+    const __m128i wanted = _mm_set1_epi8((char)value);
+    for (; i + 16 <= n; i += 16) {
+        __m128i lane = _mm_loadu_si128((const __m128i*)(values + i));
+        count += __builtin_popcount(_mm_movemask_epi8(_mm_cmpeq_epi8(lane, wanted)));
+    }
+#endif
+    for (; i < n; i++) {
+        count += (values[i] == value);
+    }
+    return count;
+}
+
+//Number of processes in the table currently in state. The engine keeps a live count instead, so this
+//scan is kept here as a reference point for the other column kernels
+std::size_t count_in_state(const process_table &table, states state) {
+    return count_equal(table.state.data(), table.rows(), state);
+}
+
+//Bulk scans over the process table columns; an item is one row
+void add_column_scan_benchmarks(std::vector<benchmark> &benchmarks) {
+    for (std::size_t n : {100000}) {
+        std::string size = "/" + std::to_string(n);
+        benchmarks.push_back({"columns/arrivals_due" + size, [=](std::size_t iterations) {
+            process_table table = make_process_table(bench_workload(n, 0));
+            unsigned int last = table.arrival_time.back();
+            std::size_t total = 0;
+            for (std::size_t i = 0; i < iterations; i++) {
+                total += prefix_not_after(table.arrival_time.data(), n, last);
+            }
+            keep(total);
+            return iterations * n;
+        }});
+        benchmarks.push_back({"columns/in_order" + size, [=](std::size_t iterations) {
+            process_table table = make_process_table(bench_workload(n, 0));
+            std::size_t total = 0;
+            for (std::size_t i = 0; i < iterations; i++) {
+                total += non_decreasing(table.arrival_time.data(), n);
+            }
+            keep(total);
+            return iterations * n;
+        }});
+        benchmarks.push_back({"columns/count_in_state" + size, [=](std::size_t iterations) {
+            process_table table = make_process_table(bench_workload(n, 0));
+            for (std::size_t handle = 0; handle < n; handle += 3) {
+                table.state[handle] = TERMINATED;
+            }
+            std::size_t total = 0;
+            for (std::size_t i = 0; i < iterations; i++) {
+                total += count_in_state(table, TERMINATED);
+            }
+            keep(total);
+            return iterations * n;
+        }});
+    }
+}
+
+void add_output_benchmarks(std::vector<benchmark> &benchmarks) {
+    benchmarks.push_back({"output/exec_status", [](std::size_t iterations) {
+        trace_writer out("/dev/null");
+        for (std::size_t i = 0; i < iterations; i++) {
+            write_exec_status(out, i * 7, i % 1000, RUNNING, WAITING);
+        }
+        return iterations;
+    }});
+    benchmarks.push_back({"output/memory_status", [](std::size_t iterations) {
+        trace_writer out("/dev/null");
+        std::unique_ptr<memory_allocator> memory = make_allocator(memory_config());
+        std::vector<memory_partition> blocks;
+        memory->layout(blocks);
+        for (std::size_t i = 0; i < iterations; i++) {
+            blocks[i % blocks.size()].occupied = i % 2 ? -1 : (int)i;
+            write_memory_status(out, blocks, i);
+        }
+        return iterations;
+    }});
+}
+
+//------------------------------------ALLOCATION CHECK--------------------------------------------------
+//The simulation loop must not touch the heap once it is warmed up. A run is split at the point where half
+//the jobs have arrived: the first half may still fill the allocator's node pool, the second may not
+//allocate at all. This holds for every policy and allocator, and for the text, binary and metrics sinks
+//the simulator writes through as well as for a bare counting sink. The one exception is the metrics
+//sink's memory series under swapping, which can outgrow its reservation of two samples per job.
+
+struct allocation_counts {
+    std::size_t     warm_up;
+    std::size_t     steady;
+};
+
+template <typename Policy>
+allocation_counts count_loop_allocations(const std::vector<PCB> &jobs, memory_allocator &memory, Policy policy, const cpu_config &cpu,
+                                         trace_sink &trace, const memory_config &config = memory_config()) {
+    simulation_context<Policy> ctx(jobs, memory, trace, std::move(policy), cpu, config);
+
+    std::size_t start = allocation_count;
+    while (!simulation_done(ctx) && ctx.arrivals.cursor < jobs.size() / 2) {
+        if (!step_simulation(ctx)) {
+            break;
+        }
+    }
+    std::size_t warm = allocation_count;
+    run_simulation(ctx);
+    return {warm - start, allocation_count - warm};
+}
+
+template <typename Policy>
+allocation_counts count_loop_allocations(const std::vector<PCB> &jobs, memory_allocator &memory, Policy policy, const cpu_config &cpu,
+                                         const memory_config &config = memory_config()) {
+    counting_trace_sink trace;
+    return count_loop_allocations(jobs, memory, std::move(policy), cpu, trace, config);
+}
+
+//Prints one row of the check and counts it as failed if it allocated after warming up
+void report_allocations(const std::string &run, const allocation_counts &counts, int &failed) {
+    std::cout << std::left << std::setw(32) << run << std::right
+              << std::setw(16) << counts.warm_up << std::setw(16) << counts.steady << std::endl;
+    if (counts.steady > 0) {
+        failed++;
+    }
+}
+
+//Prints the allocations made inside the loop for every policy and allocator. Returns the process exit code
+int check_allocations() {
+    std::vector<PCB> jobs = bench_workload(20000, 0.5);
+    int failed = 0;
+
+    std::cout << std::left << std::setw(32) << "Run" << std::right << std::setw(16) << "Warm-up allocs"
+              << std::setw(16) << "Steady allocs" << std::endl;
+    std::cout << std::string(64, '-') << std::endl;
+    for (unsigned int cpus : {1, 4}) {
+        for (const char* policy : {"EP", "RR", "EP_RR", "MLFQ", "SJF", "SRTF", "STRIDE", "LOTTERY"}) {
+            for (const char* allocator : {"fixed", "first-fit", "best-fit", "next-fit", "buddy"}) {
+                memory_config config;
+                config.allocator = allocator;
+                std::unique_ptr<memory_allocator> memory = make_allocator(config);
+                cpu_config cpu;
+                cpu.cpus = cpus;
+
+                allocation_counts counts;
+                if (std::string(policy) == "EP") {
+                    counts = count_loop_allocations(jobs, *memory, ep_policy(), cpu);
+                } else if (std::string(policy) == "RR") {
+                    counts = count_loop_allocations(jobs, *memory, rr_policy(), cpu);
+                } else if (std::string(policy) == "EP_RR") {
+                    counts = count_loop_allocations(jobs, *memory, ep_rr_policy(), cpu);
+                } else if (std::string(policy) == "MLFQ") {
+                    run_options options;
+                    counts = count_loop_allocations(jobs, *memory, mlfq_policy(options.mlfq_quanta, options.mlfq_boost), cpu);
+                } else if (std::string(policy) == "SJF") {
+                    counts = count_loop_allocations(jobs, *memory, sjf_policy(), cpu);
+                } else if (std::string(policy) == "SRTF") {
+                    counts = count_loop_allocations(jobs, *memory, srtf_policy(), cpu);
+                } else if (std::string(policy) == "STRIDE") {
+                    counts = count_loop_allocations(jobs, *memory, stride_policy(), cpu);
+                } else {
+                    counts = count_loop_allocations(jobs, *memory, lottery_policy(run_options().lottery_seed), cpu);
+                }
+
+                std::string run = std::string(policy) + "/" + allocator + (cpus > 1 ? "/cpus:" + std::to_string(cpus) : "");
+                report_allocations(run, counts, failed);
+            }
+        }
+    }
+
+    //A saturated memory keeps the pending index busy on every termination, and fragments the dynamic
+    //allocators as far as they go, which also makes the sinks' memory snapshots as long as they get
+    std::vector<PCB> saturated = bench_workload(20000, 0.5, 1.0);
+
+    //The sinks a user actually runs with, each with every allocator. The logs go to /dev/null, and the
+    //metrics sink sits in front of the text logs as it does under --metrics
+    for (const char* sink : {"text", "binary", "metrics"}) {
+        for (const char* allocator : {"fixed", "first-fit", "best-fit", "next-fit", "buddy"}) {
+            memory_config config;
+            config.allocator = allocator;
+            std::unique_ptr<memory_allocator> memory = make_allocator(config);
+            trace_writer execution_log("/dev/null");
+            trace_writer memory_log("/dev/null");
+
+            allocation_counts counts;
+            if (std::string(sink) == "binary") {
+                binary_trace_sink trace(execution_log);
+                counts = count_loop_allocations(saturated, *memory, rr_policy(), cpu_config(), trace);
+            } else {
+                text_trace_sink text(execution_log, memory_log);
+                metrics_trace_sink metrics(saturated, &text);
+                trace_sink &trace = (std::string(sink) == "text") ? static_cast<trace_sink &>(text) : metrics;
+                counts = count_loop_allocations(saturated, *memory, rr_policy(), cpu_config(), trace);
+            }
+            report_allocations(std::string("RR/") + allocator + "/sink:" + sink, counts, failed);
+        }
+    }
+
+    for (const char* allocator : {"fixed", "first-fit", "best-fit", "next-fit", "buddy"}) {
+        for (admission_policy admission : {ADMIT_FIFO, ADMIT_BEST_FIT, ADMIT_LARGEST_FIRST}) {
+            memory_config config;
+            config.allocator = allocator;
+            config.admission = admission;
+            std::unique_ptr<memory_allocator> memory = make_allocator(config);
+            allocation_counts counts = count_loop_allocations(saturated, *memory, rr_policy(), cpu_config(), config);
+            report_allocations(std::string("RR/") + allocator + "/" + admission_names[admission], counts, failed);
+        }
+        for (swap_policy swap : {SWAP_LONGEST_IO, SWAP_SMALLEST}) {
+            memory_config config;
+            config.allocator = allocator;
+            config.swap = swap;
+            std::unique_ptr<memory_allocator> memory = make_allocator(config);
+            allocation_counts counts = count_loop_allocations(saturated, *memory, rr_policy(), cpu_config(), config);
+            report_allocations(std::string("RR/") + allocator + "/swap:" + swap_names[swap], counts, failed);
+        }
+    }
+
+    if (failed > 0) {
+        std::cerr << "Error: " << failed << " run(s) allocated after warming up" << std::endl;
+        return -1;
+    }
+    return 0;
+}
+
+//------------------------------------BASELINE----------------------------------------------------------
+//A baseline is a CSV of name,ns_per_iteration,items_per_second as written by --save
+
+std::map<std::string, double> load_baseline(const std::string &filename) {
+    std::map<std::string, double> baseline;
+    std::ifstream in(filename);
+    std::string line;
+    std::getline(in, line);
+    while (std::getline(in, line)) {
+        std::vector<std::string> fields = split_delim(line, ",");
+        if (fields.size() >= 2) {
+            baseline[fields[0]] = std::stod(fields[1]);
+        }
+    }
+    return baseline;
+}
+
+bool save_results(const std::string &filename, const std::vector<benchmark_result> &results) {
+    std::ofstream out(filename);
+    if (!out.is_open()) {
+        return false;
+    }
+    out << "name,ns_per_iteration,items_per_second\n" << std::fixed << std::setprecision(1);
+    for (const auto &result : results) {
+        out << result.name << ',' << result.ns_per_iteration << ',' << result.items_per_second << '\n';
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+
+    if (argc == 2 && std::string(argv[1]) == "--allocations") {
+        return check_allocations();
+    }
+
+    std::string filter, baseline_file, save_file;
+    double min_seconds = 0.2;
+    double tolerance = 0.10;
+    try {
+        for (int i = 1; i < argc; i += 2) {
+            std::string option = argv[i];
+            if (i + 1 >= argc) {
+                throw std::invalid_argument(option);
+            }
+            std::string value = argv[i + 1];
+            if (option == "--filter") {
+                filter = value;
+            } else if (option == "--min-time") {
+                min_seconds = std::stod(value);
+            } else if (option == "--baseline") {
+                baseline_file = value;
+            } else if (option == "--tolerance") {
+                tolerance = std::stod(value);
+            } else if (option == "--save") {
+                save_file = value;
+            } else {
+                throw std::invalid_argument(option);
+            }
+        }
+    } catch (const std::exception &) {
+        std::cout << "Usage: ./bin/bench [--filter <substring>] [--min-time <seconds>] [--baseline <file.csv>] "
+                  << "[--tolerance <fraction>] [--save <file.csv>]\n       ./bin/bench --allocations" << std::endl;
+        return -1;
+    }
+
+    std::map<std::string, double> baseline;
+    if (!baseline_file.empty()) {
+        baseline = load_baseline(baseline_file);
+        if (baseline.empty()) {
+            std::cerr << "Error: Unable to read baseline: " << baseline_file << std::endl;
+            return -1;
+        }
+    }
+
+    std::vector<benchmark> benchmarks;
+    add_simulation_benchmarks(benchmarks);
+    add_admission_benchmarks(benchmarks);
+    add_memory_benchmarks(benchmarks);
+    add_ready_queue_benchmarks(benchmarks);
+    add_sync_queue_benchmarks(benchmarks);
+    add_column_scan_benchmarks(benchmarks);
+    add_output_benchmarks(benchmarks);
+
+    std::cout << std::left << std::setw(36) << "Benchmark" << std::right << std::setw(16) << "Time/iter (ns)"
+              << std::setw(16) << "Items/s" << std::setw(12) << "vs base" << std::endl;
+    std::cout << std::string(80, '-') << std::endl;
+
+    std::vector<benchmark_result> results;
+    int regressions = 0;
+    for (const auto &bench : benchmarks) {
+        if (bench.name.find(filter) == std::string::npos) {
+            continue;
+        }
+        benchmark_result result = measure(bench, min_seconds);
+        results.push_back(result);
+
+        std::cout << std::left << std::setw(36) << result.name << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(16) << result.ns_per_iteration << std::setw(16) << std::setprecision(0) << result.items_per_second;
+        auto base = baseline.find(result.name);
+        if (base != baseline.end()) {
+            double change = result.ns_per_iteration / base->second - 1;
+            std::cout << std::setw(11) << std::showpos << std::setprecision(1) << 100 * change << "%" << std::noshowpos;
+            if (change > tolerance) {
+                std::cout << "  REGRESSION";
+                regressions++;
+            }
+        }
+        std::cout << std::endl;
+    }
+
+    if (!save_file.empty() && !save_results(save_file, results)) {
+        std::cerr << "Error opening file!" << std::endl;
+        return -1;
+    }
+    if (regressions > 0) {
+        std::cerr << "Error: " << regressions << " benchmark(s) slower than the baseline by more than "
+                  << 100 * tolerance << "%" << std::endl;
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,1227 @@
+/**
+ * @file interrupts_101311131_101311339_engine.hpp
+ * @author Sasisekhar Govind, Yuvraj Bains, James Bian
+ * @brief The simulation engine shared by every scheduling policy
+ *
+ */
+
+#ifndef INTERRUPTS_ENGINE_HPP_
+#define INTERRUPTS_ENGINE_HPP_
+
+#include "interrupts_101311131_101311339.hpp"
+#include "interrupts_101311131_101311339_trace.hpp"
+#include "interrupts_101311131_101311339_metrics.hpp"
+#include "interrupts_101311131_101311339_input.hpp"
+#include<chrono>
+
+//------------------------------------SCHEDULING POLICIES-----------------------------------------------
+//A policy owns the ready queue and decides when the running process gives up the CPU. The engine is a
+//template over the policy, so each policy gets its own compiled loop with no virtual calls in it.
+//Every policy provides:
+//  reserve(n)                      room for n processes
+//  push(handle, table, reason)     a process became ready; reason says how
+//  pop(), empty(), size()          the next process to run, and the queue length
+//  preempt(handle, table, slice)   whether the running process gives up the CPU now
+//  quantum_for(handle, table)      time slice of the running process (0 = no time slicing)
+//  wakeup(t), next_wakeup()        timed work of the policy, run at the start of every tick; next_wakeup()
+//                                  is the next tick the policy needs to see (0 = none)
+//  save(), load()                  checkpoints
+
+//Why a process joins the ready queue
+enum ready_reason {
+    ADMITTED,   //Arrived and got its memory
+    WOKEN,      //Finished its I/O
+    EXPIRED,    //Used up its time slice
+    PREEMPTED   //Displaced by a process that goes first
+};
+
+//External priorities, non-preemptive: the lowest priority value runs first and keeps the CPU until it
+//blocks or ends
+struct ep_policy {
+    unsigned int    quantum = 0;
+    ready_heap      ready;
+
+    void reserve(std::size_t n) {
+        ready.reserve(n);
+    }
+
+    void push(std::size_t handle, process_table &table, ready_reason) {
+        ready.push(handle, table.priority[handle]);
+    }
+
+    std::size_t pop() {
+        return ready.pop();
+    }
+
+    bool empty() const {
+        return ready.empty();
+    }
+
+    std::size_t size() const {
+        return ready.size();
+    }
+
+    bool preempt(std::size_t, const process_table &, unsigned int) const {
+        return false;
+    }
+
+    unsigned int quantum_for(std::size_t, const process_table &) const {
+        return quantum;
+    }
+
+    void wakeup(unsigned int) {}
+
+    unsigned int next_wakeup() const {
+        return 0;
+    }
+
+    void save(checkpoint_writer &out) const {
+        ready.save(out);
+    }
+
+    bool load(checkpoint_reader &in) {
+        return ready.load(in);
+    }
+};
+
+//Round robin: FIFO ready queue, the running process goes to the back when its quantum expires
+struct rr_policy {
+    unsigned int    quantum = TIME_QUANTUM;
+    handle_ring     ready;
+
+    void reserve(std::size_t n) {
+        ready.reserve(n);
+    }
+
+    void push(std::size_t handle, process_table &, ready_reason) {
+        ready.push_back(handle);
+    }
+
+    std::size_t pop() {
+        return ready.pop_front();
+    }
+
+    bool empty() const {
+        return ready.empty();
+    }
+
+    std::size_t size() const {
+        return ready.size();
+    }
+
+    bool preempt(std::size_t, const process_table &, unsigned int time_slice_counter) const {
+        return time_slice_counter >= quantum;
+    }
+
+    unsigned int quantum_for(std::size_t, const process_table &) const {
+        return quantum;
+    }
+
+    void wakeup(unsigned int) {}
+
+    unsigned int next_wakeup() const {
+        return 0;
+    }
+
+    void save(checkpoint_writer &out) const {
+        ready.save(out);
+    }
+
+    bool load(checkpoint_reader &in) {
+        return ready.load(in);
+    }
+};
+
+//External priorities with preemption and round robin: the running process is preempted when its quantum
+//expires or when a process with a lower priority value is ready
+struct ep_rr_policy {
+    unsigned int    quantum = TIME_QUANTUM;
+    ready_heap      ready;
+
+    void reserve(std::size_t n) {
+        ready.reserve(n);
+    }
+
+    void push(std::size_t handle, process_table &table, ready_reason) {
+        ready.push(handle, table.priority[handle]);
+    }
+
+    std::size_t pop() {
+        return ready.pop();
+    }
+
+    bool empty() const {
+        return ready.empty();
+    }
+
+    std::size_t size() const {
+        return ready.size();
+    }
+
+    bool preempt(std::size_t running, const process_table &table, unsigned int time_slice_counter) const {
+        return time_slice_counter >= quantum || (!ready.empty() && ready.top_key() < table.priority[running]);
+    }
+
+    unsigned int quantum_for(std::size_t, const process_table &) const {
+        return quantum;
+    }
+
+    void wakeup(unsigned int) {}
+
+    unsigned int next_wakeup() const {
+        return 0;
+    }
+
+    void save(checkpoint_writer &out) const {
+        ready.save(out);
+    }
+
+    bool load(checkpoint_reader &in) {
+        return ready.load(in);
+    }
+};
+
+//Multilevel feedback queue: one FIFO per level, level 0 first, each with its own quantum. A process enters at
+//the top, drops a level when it uses up its quantum and rises one when it comes back from I/O, so interactive
+//jobs stay near the top. Every boost_period ms every process goes back to the top level, so CPU-bound jobs
+//cannot starve. A ready process on a higher level than the running one preempts it.
+//A bitmask of the non-empty levels makes every operation O(1). Levels live in the process table so they
+//follow a process between CPUs; a boost only bumps the epoch, which invalidates every stored level at once.
+struct mlfq_policy {
+    std::vector<unsigned int>   quanta;
+    unsigned int                boost_period;
+    std::vector<handle_ring>    levels;
+    std::uint32_t               occupied = 0;   //Bit per level with a queued process
+    std::size_t                 queued = 0;
+    unsigned int                epoch = 0;      //Boosts so far
+    unsigned int                next_boost;
+
+    mlfq_policy(const std::vector<unsigned int> &quanta, unsigned int boost_period)
+        : quanta(quanta), boost_period(boost_period), levels(quanta.size()), next_boost(boost_period) {}
+
+    unsigned int level_of(std::size_t handle, const process_table &table) const {
+        return table.level_epoch[handle] == epoch ? table.level[handle] : 0;
+    }
+
+    void reserve(std::size_t n) {
+        for (auto &level : levels) {
+            level.reserve(n);
+        }
+    }
+
+    void push(std::size_t handle, process_table &table, ready_reason reason) {
+        unsigned int level = level_of(handle, table);
+        if (reason == ADMITTED) {
+            level = 0;
+        } else if (reason == WOKEN && level > 0) {
+            level--;
+        } else if (reason == EXPIRED && level + 1 < levels.size()) {
+            level++;
+        }
+        table.level[handle] = level;
+        table.level_epoch[handle] = epoch;
+        levels[level].push_back(handle);
+        occupied |= 1u << level;
+        queued++;
+    }
+
+    std::size_t pop() {
+        unsigned int level = __builtin_ctz(occupied);
+        std::size_t handle = levels[level].pop_front();
+        if (levels[level].empty()) {
+            occupied &= ~(1u << level);
+        }
+        queued--;
+        return handle;
+    }
+
+    bool empty() const {
+        return queued == 0;
+    }
+
+    std::size_t size() const {
+        return queued;
+    }
+
+    bool preempt(std::size_t running, const process_table &table, unsigned int time_slice_counter) const {
+        unsigned int level = level_of(running, table);
+        return time_slice_counter >= quanta[level] || (occupied & ((1u << level) - 1)) != 0;
+    }
+
+    unsigned int quantum_for(std::size_t running, const process_table &table) const {
+        return quanta[level_of(running, table)];
+    }
+
+    //Boosts everything queued to the top level, keeping higher levels ahead of lower ones
+    void wakeup(unsigned int current_time) {
+        if (boost_period == 0 || current_time < next_boost) {
+            return;
+        }
+        epoch++;
+        for (std::size_t level = 1; level < levels.size(); level++) {
+            while (!levels[level].empty()) {
+                levels[0].push_back(levels[level].pop_front());
+            }
+        }
+        occupied = (queued > 0) ? 1 : 0;
+        next_boost = current_time - current_time % boost_period + boost_period;
+    }
+
+    unsigned int next_wakeup() const {
+        return boost_period > 0 ? next_boost : 0;
+    }
+
+    void save(checkpoint_writer &out) const {
+        for (const auto &level : levels) {
+            level.save(out);
+        }
+        out.put(occupied);
+        out.put(queued);
+        out.put(epoch);
+        out.put(next_boost);
+    }
+
+    bool load(checkpoint_reader &in) {
+        for (auto &level : levels) {
+            if (!level.load(in)) {
+                return false;
+            }
+        }
+        return in.get(occupied) && in.get(queued) && in.get(epoch) && in.get(next_boost);
+    }
+};
+
+//Shortest job first, non-preemptive: the ready process with the least CPU time left runs first and keeps
+//the CPU until it blocks or ends
+struct sjf_policy {
+    burst_heap      ready;
+
+    void reserve(std::size_t n) {
+        ready.reserve(n);
+    }
+
+    void push(std::size_t handle, process_table &table, ready_reason) {
+        ready.push(handle, table.remaining_time[handle]);
+    }
+
+    std::size_t pop() {
+        return ready.pop();
+    }
+
+    bool empty() const {
+        return ready.empty();
+    }
+
+    std::size_t size() const {
+        return ready.size();
+    }
+
+    bool preempt(std::size_t, const process_table &, unsigned int) const {
+        return false;
+    }
+
+    unsigned int quantum_for(std::size_t, const process_table &) const {
+        return 0;
+    }
+
+    void wakeup(unsigned int) {}
+
+    unsigned int next_wakeup() const {
+        return 0;
+    }
+
+    void save(checkpoint_writer &out) const {
+        ready.save(out);
+    }
+
+    bool load(checkpoint_reader &in) {
+        return ready.load(in);
+    }
+};
+
+//Shortest remaining time first: SJF that preempts the running process as soon as a ready one has strictly
+//less CPU time left
+struct srtf_policy {
+    burst_heap      ready;
+
+    void reserve(std::size_t n) {
+        ready.reserve(n);
+    }
+
+    void push(std::size_t handle, process_table &table, ready_reason) {
+        ready.push(handle, table.remaining_time[handle]);
+    }
+
+    std::size_t pop() {
+        return ready.pop();
+    }
+
+    bool empty() const {
+        return ready.empty();
+    }
+
+    std::size_t size() const {
+        return ready.size();
+    }
+
+    //The table holds the running process's remaining time as of its dispatch, and it has run for
+    //time_slice_counter ms since
+    bool preempt(std::size_t running, const process_table &table, unsigned int time_slice_counter) const {
+        return !ready.empty() && ready.top_key() < table.remaining_time[running] - time_slice_counter;
+    }
+
+    unsigned int quantum_for(std::size_t, const process_table &) const {
+        return 0;
+    }
+
+    void wakeup(unsigned int) {}
+
+    unsigned int next_wakeup() const {
+        return 0;
+    }
+
+    void save(checkpoint_writer &out) const {
+        ready.save(out);
+    }
+
+    bool load(checkpoint_reader &in) {
+        return ready.load(in);
+    }
+};
+
+//Pass a process with one ticket is charged per ms of CPU time; a process with t tickets is charged 1/t of it
+const unsigned long long STRIDE_ONE = 1ULL << 20;
+
+//Stride scheduling: deterministic proportional share. Each process has a pass that grows by its stride
+//(STRIDE_ONE / tickets) for every ms it runs, and the lowest pass runs next for up to one quantum, so over
+//time every process gets CPU in proportion to its tickets.
+//The pass is derived from the CPU time used so far plus a per-process base in the table, so nothing has to
+//be charged when a process leaves the CPU. Arrivals start at the pass of the last dispatch, and so do
+//processes back from I/O that fell behind it, so sleeping never banks CPU time.
+struct stride_policy {
+    unsigned int                    quantum = TIME_QUANTUM;
+    handle_heap<unsigned long long> ready;
+    unsigned long long              global_pass = 0;    //Pass of the last process dispatched
+
+    static unsigned long long stride(std::size_t handle, const process_table &table) {
+        return std::max(1ULL, STRIDE_ONE / table.tickets[handle]);
+    }
+
+    static unsigned long long pass_of(std::size_t handle, const process_table &table) {
+        return table.pass_base[handle] + stride(handle, table) * (table.processing_time[handle] - table.remaining_time[handle]);
+    }
+
+    void reserve(std::size_t n) {
+        ready.reserve(n);
+    }
+
+    void push(std::size_t handle, process_table &table, ready_reason reason) {
+        if (reason == ADMITTED) {
+            table.pass_base[handle] = global_pass;
+        }
+        unsigned long long pass = pass_of(handle, table);
+        if (reason == WOKEN && pass < global_pass) {
+            table.pass_base[handle] += global_pass - pass;
+            pass = global_pass;
+        }
+        ready.push(handle, pass);
+    }
+
+    std::size_t pop() {
+        global_pass = ready.top_key();
+        return ready.pop();
+    }
+
+    bool empty() const {
+        return ready.empty();
+    }
+
+    std::size_t size() const {
+        return ready.size();
+    }
+
+    bool preempt(std::size_t, const process_table &, unsigned int time_slice_counter) const {
+        return time_slice_counter >= quantum;
+    }
+
+    unsigned int quantum_for(std::size_t, const process_table &) const {
+        return quantum;
+    }
+
+    void wakeup(unsigned int) {}
+
+    unsigned int next_wakeup() const {
+        return 0;
+    }
+
+    void save(checkpoint_writer &out) const {
+        ready.save(out);
+        out.put(global_pass);
+    }
+
+    bool load(checkpoint_reader &in) {
+        return ready.load(in) && in.get(global_pass);
+    }
+};
+
+//Lottery scheduling: randomized proportional share. Every quantum a ticket is drawn among the queued
+//processes and its holder runs, so each process wins in proportion to its tickets. The draws come from
+//a seeded splitmix64 generator, whose whole state is one word, so runs repeat exactly and checkpoint
+//cheaply.
+struct lottery_policy {
+    unsigned int        quantum = TIME_QUANTUM;
+    ticket_tree         ready;
+    std::uint64_t       random_state;
+
+    explicit lottery_policy(unsigned long long seed) : random_state(seed) {}
+
+    std::uint64_t draw() {
+        std::uint64_t z = (random_state += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    void reserve(std::size_t n) {
+        ready.reserve(n);
+    }
+
+    void push(std::size_t handle, process_table &table, ready_reason) {
+        ready.add(handle, table.tickets[handle]);
+    }
+
+    std::size_t pop() {
+        std::size_t handle = ready.find(draw() % ready.total);
+        ready.remove(handle);
+        return handle;
+    }
+
+    bool empty() const {
+        return ready.empty();
+    }
+
+    std::size_t size() const {
+        return ready.size();
+    }
+
+    bool preempt(std::size_t, const process_table &, unsigned int time_slice_counter) const {
+        return time_slice_counter >= quantum;
+    }
+
+    unsigned int quantum_for(std::size_t, const process_table &) const {
+        return quantum;
+    }
+
+    void wakeup(unsigned int) {}
+
+    unsigned int next_wakeup() const {
+        return 0;
+    }
+
+    void save(checkpoint_writer &out) const {
+        ready.save(out);
+        out.put(random_state);
+    }
+
+    bool load(checkpoint_reader &in) {
+        return ready.load(in) && in.get(random_state);
+    }
+};
+
+//------------------------------------SIMULATION ENGINE-------------------------------------------------
+//Everything one simulation touches lives in its simulation_context and is passed explicitly, so any number
+//of simulations can run side by side in one process. The allocator and trace sink are borrowed: the caller
+//owns them and must keep them alive for as long as the context.
+//The constructor sizes the PCB pool and every queue for the whole job list, so the loop itself runs
+//without touching the heap (bin/bench --allocations checks this).
+//
+//The machine has one or more CPUs, each with its own run queue (a copy of the policy) and running process.
+//New arrivals join the shortest queue; processes woken from I/O go back to the CPU they last ran on under
+//soft affinity and to the shortest queue otherwise; a preempted process stays on its own CPU. A CPU that
+//goes idle with an empty queue steals the next process from the longest other queue. With one CPU this is
+//exactly the uniprocessor scheduler.
+//
+//With swapping on, a job that cannot get memory may evict a process blocked on I/O: the victim is suspended
+//and its memory freed, its I/O carries on, and once that is done it waits in the pending index next to the
+//new arrivals. Getting memory back costs it swap_latency ms before it is ready again.
+
+template <typename Policy>
+struct cpu_core {
+    //Starts idle with an empty copy of policy as its ready queue
+    explicit cpu_core(const Policy &policy) : ready(policy) {
+        idle_CPU(running);
+    }
+
+    Policy              ready;
+    PCB                 running;
+    std::size_t         handle = 0;     //Of the running process
+    unsigned int        time_slice_counter = 0;
+};
+
+template <typename Policy>
+struct simulation_context {
+    memory_allocator    &memory;
+    trace_sink          &trace;
+    bool                affinity;
+    admission_policy    admission;
+    swap_policy         swap;
+    unsigned int        swap_latency;
+    std::vector<cpu_core<Policy>>   cpus;
+
+    process_table       table;
+    io_heap             wait_queue;
+    io_heap             swap_queue;     //Processes being swapped back in, keyed on the tick they are ready
+    event_queue         events;
+    arrival_stream      arrivals;
+
+    unsigned int        current_time = 0;
+    bool                admission_due = false;  //Memory was freed or a process can be swapped out, so pending jobs get another look
+    unsigned int        policy_timer = 0;   //Tick of the pending POLICY_TIMER event, 0 if there is none
+
+    simulation_context(std::vector<PCB> list_processes, memory_allocator &memory, trace_sink &trace, Policy policy,
+                       const cpu_config &cpu = cpu_config(), const memory_config &config = memory_config())
+        : memory(memory), trace(trace), affinity(cpu.affinity), admission(config.admission), swap(config.swap),
+          swap_latency(config.swap_latency), table(make_process_table(list_processes)),
+          arrivals(make_arrival_stream(table.arrival_time, table.size)) {
+        std::size_t jobs = table.rows();
+        //Stealing can pile every job onto one queue, so each is sized for all of them
+        cpus.reserve(std::max(1u, cpu.cpus));
+        for (unsigned int c = 0; c < std::max(1u, cpu.cpus); c++) {
+            cpus.emplace_back(policy);
+            cpus.back().ready.reserve(jobs);
+        }
+        wait_queue.reserve(jobs);
+        memory.reserve(jobs);
+        swap_queue.reserve(jobs);
+        //Room for one I/O completion per process plus the handful of clock events per CPU
+        events.reserve(jobs + 64 * cpus.size());
+
+        schedule_next_arrival(events, arrivals, table);
+    }
+};
+
+//Returns true once every job has arrived and terminated
+template <typename Policy>
+bool simulation_done(const simulation_context<Policy> &ctx) {
+    return all_process_terminated(ctx.table) && arrivals_done(ctx.arrivals);
+}
+
+//CPU with the fewest processes queued or running, the lowest numbered on a tie
+template <typename Policy>
+unsigned int least_loaded_cpu(const simulation_context<Policy> &ctx) {
+    unsigned int best = 0;
+    std::size_t best_load = SIZE_MAX;
+    for (unsigned int c = 0; c < ctx.cpus.size(); c++) {
+        std::size_t load = ctx.cpus[c].ready.size() + (ctx.cpus[c].running.state == RUNNING ? 1 : 0);
+        if (load < best_load) {
+            best = c;
+            best_load = load;
+        }
+    }
+    return best;
+}
+
+//Puts a process on the run queue of cpu
+template <typename Policy>
+void enqueue(simulation_context<Policy> &ctx, unsigned int cpu, std::size_t handle, ready_reason reason) {
+    ctx.table.last_cpu[handle] = cpu;
+    ctx.cpus[cpu].ready.push(handle, ctx.table, reason);
+}
+
+//Takes the next process for an idle cpu: from its own queue, or else from the longest other queue.
+//Returns false if every queue is empty
+template <typename Policy>
+bool next_for_cpu(simulation_context<Policy> &ctx, unsigned int cpu, std::size_t &handle) {
+    if (!ctx.cpus[cpu].ready.empty()) {
+        handle = ctx.cpus[cpu].ready.pop();
+        return true;
+    }
+    std::size_t victim = cpu;
+    std::size_t longest = 0;
+    for (std::size_t c = 0; c < ctx.cpus.size(); c++) {
+        if (ctx.cpus[c].ready.size() > longest) {
+            victim = c;
+            longest = ctx.cpus[c].ready.size();
+        }
+    }
+    if (longest == 0) {
+        return false;
+    }
+    handle = ctx.cpus[victim].ready.pop();
+    return true;
+}
+
+//Returns true if any run queue holds a process
+template <typename Policy>
+bool any_ready(const simulation_context<Policy> &ctx) {
+    for (const auto &core : ctx.cpus) {
+        if (!core.ready.empty()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+//Processes queued on every CPU, not counting the running ones
+template <typename Policy>
+std::size_t ready_processes(const simulation_context<Policy> &ctx) {
+    std::size_t ready = 0;
+    for (const auto &core : ctx.cpus) {
+        ready += core.ready.size();
+    }
+    return ready;
+}
+
+//Readies a process that is back in memory and queues it like one woken from I/O
+template <typename Policy>
+void finish_swap_in(simulation_context<Policy> &ctx, std::size_t handle) {
+    ctx.table.state[handle] = READY;
+    ctx.table.start_time[handle] = -1;
+    unsigned int cpu = ctx.affinity ? ctx.table.last_cpu[handle] : least_loaded_cpu(ctx);
+    enqueue(ctx, cpu, handle, WOKEN);
+    ctx.trace.transition(ctx.current_time, cpu, ctx.table.PID[handle], SUSPENDED_READY, READY);
+}
+
+//Gives memory to pending jobs in the order the admission policy picks them, for as long as they fit.
+//New jobs become ready at once; swapped out processes are ready swap_latency ms later
+template <typename Policy>
+void admit_pending(simulation_context<Policy> &ctx) {
+    unsigned int largest;
+    std::size_t job;
+    while (ctx.memory.largest_free(largest) && take_admission(ctx.arrivals, ctx.admission, largest, job)) {
+        PCB p = ctx.table.get(job);
+        if (!assign_memory(ctx.memory, p)) {
+            wait_for_memory(ctx.arrivals, job);
+            break;
+        }
+        ctx.table.set(job, p);
+        if (p.state == SUSPENDED_READY) {
+            ctx.trace.memory_snapshot(ctx.memory, ctx.current_time);
+            if (ctx.swap_latency == 0) {
+                finish_swap_in(ctx, job);
+            } else {
+                ctx.swap_queue.push(job, ctx.current_time + ctx.swap_latency);
+                schedule_event(ctx.events, ctx.current_time + ctx.swap_latency, SWAP_COMPLETION, p.PID);
+            }
+            continue;
+        }
+        ctx.table.state[job] = READY;
+        add_to_table(ctx.table, job);
+        unsigned int cpu = least_loaded_cpu(ctx);
+        enqueue(ctx, cpu, job, ADMITTED);
+        ctx.trace.transition(ctx.current_time, cpu, p.PID, NEW, READY);
+        ctx.trace.memory_snapshot(ctx.memory, ctx.current_time);
+    }
+}
+
+//Swaps out one blocked process to make room for the job the admission policy wants next. Candidates are
+//resident processes on I/O at least as large as that job, whose I/O outlasts the swap latency (any other
+//would only come back later than it would have been ready anyway). Returns false if there is none
+template <typename Policy>
+bool swap_out_for_pending(simulation_context<Policy> &ctx) {
+    unsigned int size;
+    unsigned int largest;
+    if (!next_admission_size(ctx.arrivals, ctx.admission, size) || (ctx.memory.largest_free(largest) && largest >= size)) {
+        return false;
+    }
+
+    bool found = false;
+    std::size_t victim = 0;
+    unsigned int victim_io_end = 0;
+    for (const auto &entry : ctx.wait_queue.heap) {
+        std::size_t handle = entry.handle;
+        if (ctx.table.state[handle] != WAITING || ctx.table.size[handle] < size || entry.key <= ctx.current_time + ctx.swap_latency) {
+            continue;
+        }
+        bool better;
+        if (!found) {
+            better = true;
+        } else if (ctx.swap == SWAP_LONGEST_IO) {
+            better = entry.key != victim_io_end ? entry.key > victim_io_end : handle < victim;
+        } else {
+            better = ctx.table.size[handle] != ctx.table.size[victim] ? ctx.table.size[handle] < ctx.table.size[victim] : handle < victim;
+        }
+        if (better) {
+            found = true;
+            victim = handle;
+            victim_io_end = entry.key;
+        }
+    }
+    if (!found) {
+        return false;
+    }
+
+    PCB p = ctx.table.get(victim);
+    free_memory(ctx.memory, p);
+    p.state = SUSPENDED_WAITING;
+    ctx.table.set(victim, p);
+    ctx.trace.transition(ctx.current_time, ctx.table.last_cpu[victim], p.PID, WAITING, SUSPENDED_WAITING);
+    ctx.trace.memory_snapshot(ctx.memory, ctx.current_time);
+    return true;
+}
+
+//Processes the current tick and advances the clock to the next tick where something happens.
+//Returns false if there is nothing left to simulate
+template <typename Policy>
+bool step_simulation(simulation_context<Policy> &ctx) {
+    PROFILE_STEP(ctx.current_time);
+    PROFILE_BEGIN(PHASE_WAKEUP);
+    for (auto &core : ctx.cpus) {
+        core.ready.wakeup(ctx.current_time);
+    }
+
+    // ----------------- SWAP-INS -----------------
+    PROFILE_NEXT(PHASE_SWAP_IN);
+    while (!ctx.swap_queue.empty() && ctx.swap_queue.top_key() <= ctx.current_time) {
+        finish_swap_in(ctx, ctx.swap_queue.pop());
+    }
+
+    // ----------------- MANAGE WAIT QUEUE (I/O) -----------------
+    PROFILE_NEXT(PHASE_WAIT_QUEUE);
+    while (!ctx.wait_queue.empty() && ctx.wait_queue.top_key() <= ctx.current_time) {
+        std::size_t handle = ctx.wait_queue.pop();
+        if (ctx.table.state[handle] == SUSPENDED_WAITING) {
+            // Still swapped out, so it queues for memory like a new arrival
+            ctx.table.state[handle] = SUSPENDED_READY;
+            wait_for_memory(ctx.arrivals, handle);
+            ctx.admission_due = true;
+            ctx.trace.transition(ctx.current_time, ctx.table.last_cpu[handle], ctx.table.PID[handle], SUSPENDED_WAITING, SUSPENDED_READY);
+            continue;
+        }
+        ctx.table.state[handle] = READY;
+        ctx.table.start_time[handle] = -1;
+        unsigned int cpu = ctx.affinity ? ctx.table.last_cpu[handle] : least_loaded_cpu(ctx);
+        enqueue(ctx, cpu, handle, WOKEN);
+        ctx.trace.transition(ctx.current_time, cpu, ctx.table.PID[handle], WAITING, READY);
+    }
+
+    // ----------------- ADMISSION -----------------
+    PROFILE_NEXT(PHASE_ADMISSION);
+    if (arrival_due(ctx.arrivals, ctx.table.arrival_time, ctx.current_time) || ctx.admission_due) {
+        take_arrivals(ctx.arrivals, ctx.table.arrival_time, ctx.current_time);
+        // Jobs that don't fit stay pending until a partition is freed, or one is swapped out for them
+        admit_pending(ctx);
+        while (ctx.swap != SWAP_NONE && swap_out_for_pending(ctx)) {
+            admit_pending(ctx);
+        }
+        schedule_next_arrival(ctx.events, ctx.arrivals, ctx.table);
+        ctx.admission_due = false;
+    }
+
+    // ----------------- PREEMPTION -----------------
+    PROFILE_NEXT(PHASE_PREEMPTION);
+    for (unsigned int c = 0; c < ctx.cpus.size(); c++) {
+        cpu_core<Policy> &core = ctx.cpus[c];
+        if (core.running.state == RUNNING && core.ready.preempt(core.handle, ctx.table, core.time_slice_counter)) {
+            unsigned int quantum = core.ready.quantum_for(core.handle, ctx.table);
+            core.running.state = READY;
+            sync_queue(ctx.table, core.running);
+            enqueue(ctx, c, core.handle, (quantum > 0 && core.time_slice_counter >= quantum) ? EXPIRED : PREEMPTED);
+            ctx.trace.transition(ctx.current_time, c, core.running.PID, RUNNING, READY);
+            idle_CPU(core.running);
+            core.time_slice_counter = 0;
+        }
+    }
+
+    // ----------------- DISPATCH -----------------
+    PROFILE_NEXT(PHASE_DISPATCH);
+    for (unsigned int c = 0; c < ctx.cpus.size(); c++) {
+        cpu_core<Policy> &core = ctx.cpus[c];
+        std::size_t handle;
+        if (core.running.state != RUNNING && next_for_cpu(ctx, c, handle)) {
+            run_process(core.running, ctx.table, handle, ctx.current_time);
+            ctx.table.last_cpu[handle] = c;
+            core.handle = handle;
+            core.time_slice_counter = 0;
+            ctx.trace.transition(ctx.current_time, c, core.running.PID, READY, RUNNING);
+        }
+    }
+
+    // ----------------- EXECUTE -----------------
+    PROFILE_NEXT(PHASE_EXECUTE);
+    for (unsigned int c = 0; c < ctx.cpus.size(); c++) {
+        cpu_core<Policy> &core = ctx.cpus[c];
+        if (core.running.state != RUNNING) {
+            continue;
+        }
+
+        core.running.remaining_time--;
+        core.time_slice_counter++;
+
+        // Check for Termination
+        if (core.running.remaining_time == 0) {
+            terminate_process(core.running, ctx.table, ctx.memory);
+            ctx.trace.transition(ctx.current_time + 1, c, core.running.PID, RUNNING, TERMINATED);
+            free_memory(ctx.memory, core.running);
+            ctx.admission_due = true;
+            if (ctx.arrivals.pending > 0) {
+                schedule_event(ctx.events, ctx.current_time + 1, ARRIVAL, -1);
+            }
+            idle_CPU(core.running);
+            core.time_slice_counter = 0;
+        }
+        else {
+            //If we have done work equal to Frequency, trigger I/O
+            int time_spent = core.running.processing_time - core.running.remaining_time;
+            if (core.running.io_freq > 0 && (time_spent % core.running.io_freq == 0)) {
+
+                core.running.state = WAITING;
+                // Wait starts at the END of this tick
+                core.running.start_time = ctx.current_time + 1;
+
+                ctx.wait_queue.push(core.handle, core.running.start_time + core.running.io_duration);
+                sync_queue(ctx.table, core.running);
+                schedule_event(ctx.events, core.running.start_time + core.running.io_duration, IO_COMPLETION, core.running.PID);
+
+                ctx.trace.transition(ctx.current_time + 1, c, core.running.PID, RUNNING, WAITING);
+                if (ctx.swap != SWAP_NONE && ctx.arrivals.pending > 0) {
+                    // A new swap candidate for the jobs waiting for memory
+                    ctx.admission_due = true;
+                    schedule_event(ctx.events, ctx.current_time + 1, ARRIVAL, -1);
+                }
+                idle_CPU(core.running);
+                core.time_slice_counter = 0;
+            }
+        }
+    }
+
+    // ----------------- ADVANCE TO NEXT EVENT -----------------
+    PROFILE_NEXT(PHASE_ADVANCE);
+    PROFILE_QUEUES(ready_processes(ctx), ctx.wait_queue.size(), ctx.arrivals.pending, ctx.events.size());
+    bool ready = any_ready(ctx);
+    for (auto &core : ctx.cpus) {
+        if (core.running.state == RUNNING) {
+            schedule_running(ctx.events, core.running, ctx.current_time, core.time_slice_counter,
+                             core.ready.quantum_for(core.handle, ctx.table));
+        } else if (ready) {
+            schedule_event(ctx.events, ctx.current_time + 1, DISPATCH, -1);
+        }
+    }
+    //Every CPU's policy runs on the same clock, so the first one speaks for all of them. The timer only
+    //matters while there are processes in the system
+    unsigned int timer = ctx.cpus[0].ready.next_wakeup();
+    if (timer > ctx.current_time && timer != ctx.policy_timer && ctx.table.live > 0) {
+        schedule_event(ctx.events, timer, POLICY_TIMER, -1);
+        ctx.policy_timer = timer;
+    }
+
+    unsigned int next_time;
+    if (!next_event_time(ctx.events, ctx.current_time, next_time)) {
+        return false;
+    }
+    for (auto &core : ctx.cpus) {
+        if (core.running.state == RUNNING) {
+            core.time_slice_counter += next_time - ctx.current_time - 1;
+        }
+        advance_running(core.running, next_time - ctx.current_time - 1);
+    }
+    ctx.current_time = next_time;
+    return true;
+}
+
+template <typename Policy>
+void run_simulation(simulation_context<Policy> &ctx) {
+    // Loop until all processes are terminated
+    while (!simulation_done(ctx)) {
+        if (!step_simulation(ctx)) {
+            break;
+        }
+    }
+}
+
+//------------------------------------CHECKPOINTS-------------------------------------------------------
+//A checkpoint holds everything step_simulation reads: the clock, the hot process table columns, every
+//queue in its internal order, each CPU, the allocator and the trace sink, which records how far its
+//files had got. The job list itself is not saved, only a fingerprint of it; resuming reloads the trace
+//and rebuilds the arrival order from it. Checkpoints are written to a temporary file and renamed over
+//the previous one, so a crash while writing never leaves a torn checkpoint behind.
+
+const char CHECKPOINT_MAGIC[8] = {'S', 'Y', 'S', 'C', 'C', 'K', 'P', '\0'};
+const std::uint32_t CHECKPOINT_VERSION = 6;
+
+//Steps between looks at the wall clock
+const std::size_t CHECKPOINT_CHECK_STEPS = 1024;
+
+//FNV-1a over the columns that come from the input trace
+std::uint64_t table_fingerprint(const process_table &table) {
+    std::uint64_t hash = 14695981039346656037ULL;
+    auto mix = [&hash](std::uint64_t value) {
+        for (int byte = 0; byte < 8; byte++) {
+            hash = (hash ^ ((value >> (8 * byte)) & 0xff)) * 1099511628211ULL;
+        }
+    };
+    for (std::size_t i = 0; i < table.rows(); i++) {
+        mix(table.PID[i]);
+        mix(table.size[i]);
+        mix(table.arrival_time[i]);
+        mix(table.processing_time[i]);
+        mix(table.io_freq[i]);
+        mix(table.io_duration[i]);
+        mix(table.priority[i]);
+        mix(table.tickets[i]);
+    }
+    return hash;
+}
+
+//Writes a checkpoint of ctx to config.file. Returns false if it could not be written
+template <typename Policy>
+bool save_checkpoint(simulation_context<Policy> &ctx, const checkpoint_config &config) {
+    PROFILE_SCOPE(PHASE_CHECKPOINT);
+    std::string temporary = config.file + ".tmp";
+    checkpoint_writer out(temporary.c_str());
+    if (!out.is_open()) {
+        return false;
+    }
+
+    out.put(CHECKPOINT_MAGIC);
+    out.put(CHECKPOINT_VERSION);
+    out.put_string(config.key);
+    out.put(table_fingerprint(ctx.table));
+
+    out.put(ctx.current_time);
+    out.put(ctx.admission_due);
+    ctx.table.save(out);
+    ctx.wait_queue.save(out);
+    ctx.swap_queue.save(out);
+    ctx.events.save(out);
+    out.put(ctx.arrivals.cursor);
+    out.put_vector(pending_jobs(ctx.arrivals));
+    out.put(ctx.policy_timer);
+    for (const auto &core : ctx.cpus) {
+        out.put(core.running);
+        out.put(core.handle);
+        out.put(core.time_slice_counter);
+        core.ready.save(out);
+    }
+    ctx.memory.save(out);
+    ctx.trace.save(out);
+
+    return out.close() && std::rename(temporary.c_str(), config.file.c_str()) == 0;
+}
+
+//Restores ctx, freshly built from the same jobs and options, from the checkpoint config.resume.
+//Returns false and fills in error if the checkpoint is unreadable or belongs to a different run
+template <typename Policy>
+bool load_checkpoint(simulation_context<Policy> &ctx, const checkpoint_config &config, std::string &error) {
+    checkpoint_reader in(config.resume.c_str());
+    if (!in.is_open()) {
+        error = "unable to open checkpoint " + config.resume;
+        return false;
+    }
+
+    char magic[8];
+    std::uint32_t version;
+    std::string key;
+    std::uint64_t fingerprint;
+    if (!in.get(magic) || std::memcmp(magic, CHECKPOINT_MAGIC, sizeof(magic)) != 0 || !in.get(version) || version != CHECKPOINT_VERSION) {
+        error = config.resume + " is not a checkpoint";
+        return false;
+    }
+    if (!in.get_string(key) || key != config.key || !in.get(fingerprint) || fingerprint != table_fingerprint(ctx.table)) {
+        error = config.resume + " was taken from a different input file or options";
+        return false;
+    }
+
+    std::vector<std::size_t> pending;
+    bool ok = in.get(ctx.current_time) && in.get(ctx.admission_due) && ctx.table.load(in) && ctx.wait_queue.load(in)
+              && ctx.swap_queue.load(in) && ctx.events.load(in) && in.get(ctx.arrivals.cursor) && in.get_vector(pending)
+              && ctx.arrivals.cursor <= ctx.arrivals.order.size() && in.get(ctx.policy_timer);
+    for (std::size_t job : pending) {
+        ok = ok && job < ctx.table.rows() && ctx.arrivals.pending < ctx.table.rows();
+        if (ok) {
+            wait_for_memory(ctx.arrivals, job);
+        }
+    }
+    for (auto &core : ctx.cpus) {
+        ok = ok && in.get(core.running) && in.get(core.handle) && core.handle < ctx.table.rows() && in.get(core.time_slice_counter)
+             && core.ready.load(in);
+    }
+    ok = ok && ctx.memory.load(in) && ctx.trace.load(in);
+    if (!ok) {
+        error = "corrupt checkpoint " + config.resume;
+    }
+    return ok;
+}
+
+template <typename Policy>
+void run_simulation(std::vector<PCB> list_processes, memory_allocator &memory, trace_sink &trace, Policy policy, const cpu_config &cpu,
+                    const memory_config &config = memory_config()) {
+    simulation_context<Policy> ctx(std::move(list_processes), memory, trace, std::move(policy), cpu, config);
+    run_simulation(ctx);
+}
+
+//Runs the simulation, continuing from checkpoint.resume if given and writing checkpoints to checkpoint.file
+//while it runs. Returns false and fills in error if a checkpoint cannot be loaded or written
+template <typename Policy>
+bool run_simulation(std::vector<PCB> list_processes, memory_allocator &memory, trace_sink &trace, Policy policy, const cpu_config &cpu,
+                    const memory_config &config, const checkpoint_config &checkpoint, std::string &error) {
+    simulation_context<Policy> ctx(std::move(list_processes), memory, trace, std::move(policy), cpu, config);
+    if (!checkpoint.resume.empty() && !load_checkpoint(ctx, checkpoint, error)) {
+        return false;
+    }
+    if (checkpoint.file.empty()) {
+        run_simulation(ctx);
+        return true;
+    }
+
+    auto last_checkpoint = std::chrono::steady_clock::now();
+    std::size_t steps = 0;
+    while (!simulation_done(ctx)) {
+        if (!step_simulation(ctx)) {
+            break;
+        }
+        if (++steps % CHECKPOINT_CHECK_STEPS == 0
+            && std::chrono::steady_clock::now() - last_checkpoint >= std::chrono::seconds(checkpoint.every)) {
+            if (!save_checkpoint(ctx, checkpoint)) {
+                error = "unable to write checkpoint " + checkpoint.file;
+                return false;
+            }
+            last_checkpoint = std::chrono::steady_clock::now();
+        }
+    }
+    return true;
+}
+
+//Returns true if name is a policy the engine knows
+bool known_policy(const std::string &name) {
+    return name == "EP" || name == "RR" || name == "EP_RR" || name == "MLFQ" || name == "SJF" || name == "SRTF"
+           || name == "STRIDE" || name == "LOTTERY";
+}
+
+//Returns true if the policy slices time by --quantum; EP, SJF and SRTF have no time slices and MLFQ has
+//its own quanta
+bool uses_quantum(const std::string &name) {
+    return name == "RR" || name == "EP_RR" || name == "STRIDE" || name == "LOTTERY";
+}
+
+//Runs the simulation under the named policy, configured from options; the name has to pass known_policy.
+//Returns false and fills in error only if a checkpoint cannot be loaded or written
+bool run_policy(const std::string &name, const run_options &options, std::vector<PCB> list_processes, memory_allocator &memory,
+                trace_sink &trace, std::string &error) {
+    const checkpoint_config &checkpoint = options.checkpoint;
+    if (name == "EP") {
+        return run_simulation(std::move(list_processes), memory, trace, ep_policy(), options.cpu, options.memory, checkpoint, error);
+    } else if (name == "RR") {
+        rr_policy policy;
+        policy.quantum = options.quantum;
+        return run_simulation(std::move(list_processes), memory, trace, std::move(policy), options.cpu, options.memory, checkpoint, error);
+    } else if (name == "EP_RR") {
+        ep_rr_policy policy;
+        policy.quantum = options.quantum;
+        return run_simulation(std::move(list_processes), memory, trace, std::move(policy), options.cpu, options.memory, checkpoint, error);
+    } else if (name == "MLFQ") {
+        mlfq_policy policy(options.mlfq_quanta, options.mlfq_boost);
+        return run_simulation(std::move(list_processes), memory, trace, std::move(policy), options.cpu, options.memory, checkpoint, error);
+    } else if (name == "SJF") {
+        return run_simulation(std::move(list_processes), memory, trace, sjf_policy(), options.cpu, options.memory, checkpoint, error);
+    } else if (name == "SRTF") {
+        return run_simulation(std::move(list_processes), memory, trace, srtf_policy(), options.cpu, options.memory, checkpoint, error);
+    } else if (name == "STRIDE") {
+        stride_policy policy;
+        policy.quantum = options.quantum;
+        return run_simulation(std::move(list_processes), memory, trace, std::move(policy), options.cpu, options.memory, checkpoint, error);
+    } else {
+        lottery_policy policy(options.lottery_seed);
+        policy.quantum = options.quantum;
+        return run_simulation(std::move(list_processes), memory, trace, std::move(policy), options.cpu, options.memory, checkpoint, error);
+    }
+}
+
+//Same for options without checkpoints, which cannot fail
+void run_policy(const std::string &name, const run_options &options, std::vector<PCB> list_processes, memory_allocator &memory,
+                trace_sink &trace) {
+    std::string error;
+    run_policy(name, options, std::move(list_processes), memory, trace, error);
+}
+
+//Runs one simulation under policy and writes the trace and metrics that options ask for into directory.
+//Returns false if an output file could not be opened or written, or if a checkpoint could not be loaded or written,
+//in which case error says why
+bool simulate_to_directory(const run_options &options, const std::string &policy, const std::string &directory,
+                           std::vector<PCB> list_processes, memory_allocator &memory, std::string &error) {
+    bool simulated = true;
+    bool metrics_written = true;
+    bool resume = !options.checkpoint.resume.empty();
+    bool written = run_traced(options.trace, directory, options.cpu.cpus, resume, [&](trace_sink &trace) {
+        if (options.metrics.empty()) {
+            simulated = run_policy(policy, options, std::move(list_processes), memory, trace, error);
+            return simulated;
+        }
+        metrics_trace_sink metrics(list_processes, &trace, options.cpu.cpus);
+        simulated = run_policy(policy, options, std::move(list_processes), memory, metrics, error);
+        metrics_written = simulated && write_metrics(options.metrics, directory, metrics);
+        return simulated;
+    });
+    return written && simulated && metrics_written;
+}
+
+//Everything about a run that shapes its state; a checkpoint only resumes a run with the same key
+std::string run_key(const run_options &options) {
+    std::string key = options.policy + " quantum " + std::to_string(options.quantum) + " mlfq";
+    for (unsigned int quantum : options.mlfq_quanta) {
+        key += " " + std::to_string(quantum);
+    }
+    key += " boost " + std::to_string(options.mlfq_boost) + " seed " + std::to_string(options.lottery_seed) + " cpus " + std::to_string(options.cpu.cpus)
+                      + (options.cpu.affinity ? " soft" : " none") + " memory " + options.memory.allocator + " size "
+                      + std::to_string(options.memory.total_size) + " admission " + admission_names[options.memory.admission]
+                      + " swap " + swap_names[options.memory.swap] + " " + std::to_string(options.memory.swap_latency) + " partitions";
+    for (unsigned int size : options.memory.partitions) {
+        key += " " + std::to_string(size);
+    }
+    return key + " trace " + options.trace + " metrics " + options.metrics;
+}
+
+//Names of the files simulate_to_directory writes, for reporting
+std::string output_files(const run_options &options, const std::string &directory) {
+    std::string files = traced_files(options.trace, directory);
+    if (!options.metrics.empty()) {
+        files += (files.empty() ? "" : " and ") + metrics_file(options.metrics, directory);
+    }
+    return files;
+}
+
+//Command line entry point shared by bin/interrupts and the per-policy binaries, which pass their policy
+//as default_policy. Returns the process exit code
+int simulator_main(int argc, char** argv, const char* default_policy) {
+
+    run_options options;
+    options.policy = default_policy;
+    if(argc < 2 || !parse_run_options(argc, argv, 2, options) || !known_policy(options.policy)) {
+        std::cout << "Usage: " << argv[0] << " <input_file> " << RUN_OPTIONS_USAGE << std::endl;
+        return -1;
+    }
+
+    std::unique_ptr<memory_allocator> memory = make_allocator(options.memory);
+    if (!memory) {
+        std::cerr << "Error: Unknown memory allocator: " << options.memory.allocator << std::endl;
+        return -1;
+    }
+    if (!options.profile_trace.empty() && !profile_trace_to(options.profile_trace)) {
+        std::cerr << "Error: --profile-trace needs a profiling build (bash build.sh profile)" << std::endl;
+        return -1;
+    }
+
+    std::vector<PCB> list_process;
+    std::string error;
+    if (!load_processes(argv[1], list_process, error) || !check_job_sizes(list_process, *memory, error)) {
+        std::cerr << "Error: " << error << std::endl;
+        return -1;
+    }
+
+    options.checkpoint.key = run_key(options);
+    if (!simulate_to_directory(options, options.policy, options.output_dir, std::move(list_process), *memory, error)) {
+        if (error.empty()) {
+            std::cerr << "Error writing output files!" << std::endl;
+        } else {
+            std::cerr << "Error: " << error << std::endl;
+        }
+        return -1;
+    }
+    if (!output_files(options, options.output_dir).empty()) {
+        std::cout << "Output generated in " << output_files(options, options.output_dir) << std::endl;
+    }
+
+    return 0;
+}
+
+#endif
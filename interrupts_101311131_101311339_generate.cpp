@@ -0,0 +1,44 @@
+/**
+ * @file interrupts_101311131_101311339_generate.cpp
+ * @author Sasisekhar Govind, Yuvraj Bains, James Bian
+ * @brief Writes a synthetic input trace for stress testing the schedulers
+ */
+
+#include "interrupts_101311131_101311339_generate.hpp"
+
+int main(int argc, char** argv) {
+
+    workload_config config;
+    if(argc < 2 || !parse_workload_options(argc, argv, 2, config)) {
+        std::cout << "Usage: ./bin/trace_generate <output_file> [--processes <count>] [--seed <n>] [--arrival-rate <per ms>] "
+                  << "[--burst-min <ms>] [--burst-max <ms>] [--burst-alpha <shape>] [--small-fraction <0..1>] "
+                  << "[--small-max <MB>] [--large-max <MB>] [--io-bound <0..1>]" << std::endl;
+        return -1;
+    }
+
+    std::string error;
+    if (!validate_workload(config, error)) {
+        std::cerr << "Error: " << error << std::endl;
+        return -1;
+    }
+
+    trace_writer out(argv[1]);
+    if (!out.is_open()) {
+        std::cerr << "Error opening file!" << std::endl;
+        return -1;
+    }
+
+    unsigned long long written = generate_workload(config, out);
+    if (written < config.processes) {
+        std::cerr << "Error: arrival times ran past " << UINT_MAX << " ms after " << written
+                  << " processes; raise --arrival-rate" << std::endl;
+        return -1;
+    }
+    if (!out.close()) {
+        std::cerr << "Error writing " << argv[1] << std::endl;
+        return -1;
+    }
+
+    std::cout << "Generated " << written << " processes in " << argv[1] << std::endl;
+    return 0;
+}
@@ -0,0 +1,177 @@
+/**
+ * @file interrupts_101311131_101311339_generate.hpp
+ * @author Sasisekhar Govind, Yuvraj Bains, James Bian
+ * @brief Synthetic workload generator: streams input traces of any length drawn from configurable distributions
+ *
+ */
+
+#ifndef INTERRUPTS_GENERATE_HPP_
+#define INTERRUPTS_GENERATE_HPP_
+
+#include "interrupts_101311131_101311339.hpp"
+#include<cmath>
+#include<climits>
+#include<random>
+
+//------------------------------------WORKLOAD MODEL----------------------------------------------------
+//Every process is drawn independently, so the trace is written line by line in constant memory:
+//  arrivals    Poisson process: exponential gaps with mean 1 / arrival_rate ms
+//  CPU time    bounded Pareto (heavy tailed) on [burst_min, burst_max] with shape burst_alpha
+//  size        bimodal: small_fraction of the jobs fit the small partitions, the rest need the large ones
+//  I/O         io_bound_fraction of the jobs do frequent, long I/O; the rest rarely block and briefly
+//The transforms below build on the raw 64-bit output of std::mt19937_64 rather than the library's
+//distributions, so a seed always produces the same trace from the same build. The exponential and Pareto
+//draws go through std::log and std::pow, which differ in the last bit between libm implementations, so
+//other platforms may round an occasional arrival or burst differently.
+
+struct workload_config {
+    unsigned long long  processes = 1000;
+    unsigned long long  seed = 1;
+    double              arrival_rate = 0.05;        //Mean arrivals per ms
+    unsigned int        burst_min = 5;
+    unsigned int        burst_max = 5000;
+    double              burst_alpha = 1.5;
+    double              small_fraction = 0.7;
+    unsigned int        small_max = 10;             //Small jobs are 1..small_max MB (the 10, 8 and 2 MB partitions)
+    unsigned int        large_max = 40;             //Large jobs are small_max+1..large_max MB
+    double              io_bound_fraction = 0.3;
+};
+
+class workload_generator {
+public:
+    explicit workload_generator(const workload_config &config) : config(config), random(config.seed) {}
+
+    //Draws the next process; PIDs count up from 1 and arrivals never go backwards.
+    //Returns false once the arrival clock would overflow the trace's unsigned int times
+    bool next(PCB &process) {
+        clock += -std::log(1 - uniform()) / config.arrival_rate;
+        if (clock > UINT_MAX) {
+            return false;
+        }
+
+        process.PID = ++count;
+        process.priority = process.PID;
+        process.tickets = DEFAULT_TICKETS;
+        process.arrival_time = clock;
+        process.processing_time = bounded_pareto(config.burst_min, config.burst_max, config.burst_alpha);
+        if (uniform() < config.small_fraction) {
+            process.size = uniform_int(1, config.small_max);
+        } else {
+            process.size = uniform_int(config.small_max + 1, config.large_max);
+        }
+        if (uniform() < config.io_bound_fraction) {
+            process.io_freq = uniform_int(1, 20);
+            process.io_duration = uniform_int(20, 200);
+        } else {
+            process.io_freq = uniform() < 0.5 ? 0 : uniform_int(100, 1000);
+            process.io_duration = uniform_int(1, 20);
+        }
+        return true;
+    }
+
+private:
+    //Uniform on [0, 1) from the top 53 bits
+    double uniform() {
+        return (random() >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+    unsigned int uniform_int(unsigned int low, unsigned int high) {
+        return low + (unsigned int)(uniform() * (high - low + 1));
+    }
+
+    //Inverse CDF of the Pareto distribution truncated to [low, high]
+    unsigned int bounded_pareto(double low, double high, double alpha) {
+        double ratio = std::pow(low / high, alpha);
+        double value = low / std::pow(1 - uniform() * (1 - ratio), 1 / alpha);
+        return std::min<double>(std::round(value), high);
+    }
+
+    workload_config     config;
+    std::mt19937_64     random;
+    double              clock = 0;
+    int                 count = 0;
+};
+
+//Checks that the distributions can be drawn from. Returns false and fills in error otherwise
+bool validate_workload(const workload_config &config, std::string &error) {
+    if (config.processes == 0 || config.processes > INT_MAX) {
+        error = "--processes must be between 1 and " + std::to_string(INT_MAX);
+    } else if (config.arrival_rate <= 0) {
+        error = "--arrival-rate must be positive";
+    } else if (config.burst_min == 0 || config.burst_max < config.burst_min || config.burst_alpha <= 0) {
+        error = "need 0 < --burst-min <= --burst-max and --burst-alpha > 0";
+    } else if (config.small_max == 0 || config.large_max <= config.small_max) {
+        error = "need 0 < --small-max < --large-max";
+    } else if (config.small_fraction < 0 || config.small_fraction > 1 || config.io_bound_fraction < 0 || config.io_bound_fraction > 1) {
+        error = "fractions must be between 0 and 1";
+    } else {
+        return true;
+    }
+    return false;
+}
+
+//Parses the options in argv[first..argc). Returns false on an unknown or malformed option
+bool parse_workload_options(int argc, char** argv, int first, workload_config &config) {
+    try {
+        for (int i = first; i < argc; i++) {
+            std::string option = argv[i];
+            if (i + 1 >= argc) {
+                return false;
+            }
+            std::string value = argv[++i];
+
+            if (option == "--processes") {
+                config.processes = std::stoull(value);
+            } else if (option == "--seed") {
+                config.seed = std::stoull(value);
+            } else if (option == "--arrival-rate") {
+                config.arrival_rate = std::stod(value);
+            } else if (option == "--burst-min") {
+                config.burst_min = std::stoul(value);
+            } else if (option == "--burst-max") {
+                config.burst_max = std::stoul(value);
+            } else if (option == "--burst-alpha") {
+                config.burst_alpha = std::stod(value);
+            } else if (option == "--small-fraction") {
+                config.small_fraction = std::stod(value);
+            } else if (option == "--small-max") {
+                config.small_max = std::stoul(value);
+            } else if (option == "--large-max") {
+                config.large_max = std::stoul(value);
+            } else if (option == "--io-bound") {
+                config.io_bound_fraction = std::stod(value);
+            } else {
+                return false;
+            }
+        }
+    } catch (const std::exception &) {
+        return false;
+    }
+    return true;
+}
+
+//Writes config.processes lines of "PID, size, arrival, cpu_time, io_freq, io_duration". Returns the number
+//of processes written, which is smaller only if the arrival clock ran out of range
+unsigned long long generate_workload(const workload_config &config, trace_writer &out) {
+    workload_generator generator(config);
+    PCB process;
+    unsigned long long written = 0;
+    for (; written < config.processes && generator.next(process); written++) {
+        out.write_int(process.PID);
+        out.write(", ");
+        out.write_int(process.size);
+        out.write(", ");
+        out.write_int(process.arrival_time);
+        out.write(", ");
+        out.write_int(process.processing_time);
+        out.write(", ");
+        out.write_int(process.io_freq);
+        out.write(", ");
+        out.write_int(process.io_duration);
+        out.write('\n');
+    }
+    out.flush();
+    return written;
+}
+
+#endif
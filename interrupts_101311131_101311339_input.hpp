@@ -0,0 +1,147 @@
+/**
+ * @file interrupts_101311131_101311339_input.hpp
+ * @author Sasisekhar Govind, Yuvraj Bains, James Bian
+ * @brief Input trace loader: maps the file into memory and parses PCBs in place
+ *
+ */
+
+#ifndef INTERRUPTS_INPUT_HPP_
+#define INTERRUPTS_INPUT_HPP_
+
+#include "interrupts_101311131_101311339.hpp"
+#include<sys/mman.h>
+#include<sys/stat.h>
+#include<fcntl.h>
+#include<unistd.h>
+
+//------------------------------------INPUT PARSING-----------------------------------------------------
+//Each non-blank line holds "PID, size, arrival_time, cpu_time, io_freq, io_duration" and optionally a seventh
+//field, the priority, which defaults to the PID, and an eighth, the lottery tickets, which default to
+//DEFAULT_TICKETS. Fields are separated by commas and/or whitespace and anything after the eighth field is
+//ignored. The file is mapped read-only and tokenized where it lies: no per-line strings, streams or token vectors.
+
+const int INPUT_FIELDS = 6;
+const int INPUT_MAX_FIELDS = 8;
+
+inline bool is_input_separator(char c) {
+    return c == ',' || c == ' ' || c == '\t' || c == '\r';
+}
+
+//Parses a non-negative integer from [pos, end) and advances pos past it. Returns false on anything else
+bool parse_input_field(const char* &pos, const char* end, unsigned int &value) {
+    const char* start = pos;
+    unsigned long long result = 0;
+    while (pos < end && *pos >= '0' && *pos <= '9') {
+        result = result * 10 + (*pos - '0');
+        if (result > 0x7fffffffULL) {
+            return false;
+        }
+        pos++;
+    }
+    if (pos == start || (pos < end && !is_input_separator(*pos))) {
+        return false;
+    }
+    value = (unsigned int)result;
+    return true;
+}
+
+//Parses every process in [begin, end). On a malformed line or a repeated PID returns false and describes it in error
+bool parse_processes(const char* begin, const char* end, std::vector<PCB> &processes, std::string &error) {
+    static const char* field_names[INPUT_MAX_FIELDS] = {"PID", "size", "arrival_time", "cpu_time", "io_freq", "io_duration", "priority", "tickets"};
+
+    std::unordered_map<unsigned int, std::size_t> pid_lines;    //PID -> line it was first given on
+    std::size_t line_number = 0;
+    const char* pos = begin;
+    while (pos < end) {
+        const char* line_end = static_cast<const char*>(std::memchr(pos, '\n', end - pos));
+        if (line_end == nullptr) {
+            line_end = end;
+        }
+        line_number++;
+
+        unsigned int fields[INPUT_MAX_FIELDS];
+        int count = 0;
+        while (true) {
+            while (pos < line_end && is_input_separator(*pos)) {
+                pos++;
+            }
+            if (pos == line_end || count == INPUT_MAX_FIELDS) {
+                break;
+            }
+            const char* field_start = pos;
+            if (!parse_input_field(pos, line_end, fields[count])) {
+                const char* field_end = field_start;
+                while (field_end < line_end && !is_input_separator(*field_end)) {
+                    field_end++;
+                }
+                error = "line " + std::to_string(line_number) + ": invalid " + field_names[count] + " '"
+                        + std::string(field_start, field_end) + "' (expected a non-negative integer)";
+                return false;
+            }
+            count++;
+        }
+
+        if (count > 0 && count < INPUT_FIELDS) {
+            error = "line " + std::to_string(line_number) + ": expected 6 fields (PID, size, arrival_time, cpu_time, io_freq, io_duration), found "
+                    + std::to_string(count);
+            return false;
+        }
+        if (count == INPUT_MAX_FIELDS && fields[7] == 0) {
+            error = "line " + std::to_string(line_number) + ": invalid tickets '0' (expected a positive integer)";
+            return false;
+        }
+        if (count >= INPUT_FIELDS && !pid_lines.emplace(fields[0], line_number).second) {
+            error = "line " + std::to_string(line_number) + ": duplicate PID " + std::to_string(fields[0]) + " (first given on line "
+                    + std::to_string(pid_lines[fields[0]]) + ")";
+            return false;
+        }
+        if (count >= INPUT_FIELDS) {
+            int priority = (count > INPUT_FIELDS) ? fields[6] : fields[0];
+            unsigned int tickets = (count > INPUT_FIELDS + 1) ? fields[7] : DEFAULT_TICKETS;
+            processes.push_back(make_process(fields[0], fields[1], fields[2], fields[3], fields[4], fields[5], priority, tickets));
+        }
+        pos = line_end + 1;
+    }
+    return true;
+}
+
+//Maps filename into memory and parses it. Returns false with error filled in if the file cannot be read
+//or contains a malformed line
+bool load_processes(const char* filename, std::vector<PCB> &processes, std::string &error) {
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        error = std::string("Unable to open file: ") + filename;
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        error = std::string("Unable to read file: ") + filename;
+        return false;
+    }
+    if (info.st_size == 0) {
+        close(fd);
+        return true;
+    }
+
+    void* mapped = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        error = std::string("Unable to map file: ") + filename;
+        return false;
+    }
+    madvise(mapped, info.st_size, MADV_SEQUENTIAL);
+
+    const char* begin = static_cast<const char*>(mapped);
+    processes.reserve(processes.size() + info.st_size / 16);
+    bool ok = parse_processes(begin, begin + info.st_size, processes, error);
+    munmap(mapped, info.st_size);
+
+    if (!ok) {
+        error = std::string(filename) + ": " + error;
+    }
+    return ok;
+}
+
+#endif
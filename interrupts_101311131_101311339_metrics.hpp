@@ -0,0 +1,567 @@
+/**
+ * @file interrupts_101311131_101311339_metrics.hpp
+ * @author Sasisekhar Govind, Yuvraj Bains, James Bian
+ * @brief Scheduling metrics accumulated online from the transition stream of a run
+ *
+ */
+
+#ifndef INTERRUPTS_METRICS_HPP_
+#define INTERRUPTS_METRICS_HPP_
+
+#include "interrupts_101311131_101311339_trace.hpp"
+#include<cmath>
+
+//------------------------------------QUANTILE SKETCH---------------------------------------------------
+//Log-bucketed histogram: bucket i counts the values in (SKETCH_GAMMA^(i-1), SKETCH_GAMMA^i], so any
+//quantile comes back within SKETCH_ACCURACY of the true value, relatively. Values below 1 share a zero
+//bucket. Adding is O(1) and the sketch never holds more than a few thousand counters.
+
+const double SKETCH_ACCURACY = 0.01;
+const double SKETCH_GAMMA = (1 + SKETCH_ACCURACY) / (1 - SKETCH_ACCURACY);
+const double SKETCH_LOG_GAMMA = std::log(SKETCH_GAMMA);
+
+class quantile_sketch {
+public:
+    //Room for every bucket an unsigned int time can land in, so adding never allocates
+    quantile_sketch() {
+        buckets.reserve(bucket_of(UINT_MAX) + 1);
+    }
+
+    void add(double value) {
+        if (total == 0 || value < lowest) {
+            lowest = value;
+        }
+        if (total == 0 || value > highest) {
+            highest = value;
+        }
+        total++;
+        if (value < 1) {
+            zeros++;
+            return;
+        }
+        std::size_t bucket = bucket_of(value);
+        if (bucket >= buckets.size()) {
+            buckets.resize(bucket + 1, 0);
+        }
+        buckets[bucket]++;
+    }
+
+    std::size_t count() const {
+        return total;
+    }
+
+    //Value at quantile q in [0, 1], or 0 if the sketch is empty
+    double quantile(double q) const {
+        if (total == 0) {
+            return 0;
+        }
+        std::size_t rank = q * (total - 1);
+        if (rank < zeros) {
+            return lowest;
+        }
+        std::size_t seen = zeros;
+        for (std::size_t i = 0; i < buckets.size(); i++) {
+            seen += buckets[i];
+            if (seen > rank) {
+                //Midpoint of the bucket in relative terms, which is what bounds the error, kept inside
+                //the observed range so the extremes come back exact
+                double estimate = 2 * std::pow(SKETCH_GAMMA, i) / (SKETCH_GAMMA + 1);
+                return std::min(highest, std::max(lowest, estimate));
+            }
+        }
+        return highest;
+    }
+
+    void save(checkpoint_writer &out) const {
+        out.put_vector(buckets);
+        out.put(zeros);
+        out.put(total);
+        out.put(lowest);
+        out.put(highest);
+    }
+
+    bool load(checkpoint_reader &in) {
+        return in.get_vector(buckets) && in.get(zeros) && in.get(total) && in.get(lowest) && in.get(highest);
+    }
+
+private:
+    static std::size_t bucket_of(double value) {
+        return std::ceil(std::log(value) / SKETCH_LOG_GAMMA);
+    }
+
+    std::vector<std::size_t>    buckets;
+    std::size_t                 zeros = 0;
+    std::size_t                 total = 0;
+    double                      lowest = 0;
+    double                      highest = 0;
+};
+
+//------------------------------------METRICS-----------------------------------------------------------
+//A trace sink that keeps per-process timestamps as the transitions come in, and folds each process into
+//the aggregates the moment it terminates. Every transition costs O(1); nothing looks at the log again.
+//It forwards everything to an optional next sink, so it can sit in front of the text or binary logs.
+//  turnaround = termination - arrival
+//  wait       = turnaround - CPU time - time spent in I/O (waiting for memory and for the CPU)
+//  response   = first dispatch - arrival
+//  admission  = admission - arrival (waiting for memory), counted as soon as the process is admitted
+
+struct process_metrics {
+    int             PID;
+    unsigned int    size;
+    unsigned int    arrival_time;
+    unsigned int    processing_time;
+    long long       admitted = -1;
+    long long       first_run = -1;
+    long long       finish = -1;
+    unsigned int    run_start = 0;
+    unsigned int    io_start = 0;
+    unsigned int    io_time = 0;
+
+    unsigned int turnaround() const {
+        return finish - arrival_time;
+    }
+
+    unsigned int wait() const {
+        return turnaround() - processing_time - io_time;
+    }
+
+    unsigned int response() const {
+        return first_run - arrival_time;
+    }
+
+    unsigned int admission_delay() const {
+        return admitted - arrival_time;
+    }
+};
+
+//Memory held by admitted processes from time on, until the next sample
+struct memory_sample {
+    unsigned int    time;
+    unsigned int    held;
+};
+
+struct metric_distribution {
+    double          mean = 0;
+    double          p50 = 0;
+    double          p95 = 0;
+    double          p99 = 0;
+};
+
+struct run_metrics {
+    std::size_t         processes = 0;
+    std::size_t         completed = 0;
+    unsigned int        makespan = 0;           //Time of the last termination
+    double              throughput = 0;         //Completed processes per ms
+    metric_distribution turnaround;
+    metric_distribution wait;
+    metric_distribution response;
+    metric_distribution admission;
+    double              cpu_utilization = 0;    //Fraction of the makespan the CPUs were busy, averaged over the CPUs
+    unsigned int        memory_total = 0;       //MB managed by the allocator
+    unsigned int        memory_peak = 0;        //Most MB held by admitted processes at once
+    double              memory_utilization = 0; //Time-weighted mean of held / total over the makespan
+};
+
+class metrics_trace_sink : public trace_sink {
+public:
+    explicit metrics_trace_sink(const std::vector<PCB> &jobs, trace_sink* next = nullptr, unsigned int cpus = 1) : next(next), cpus(cpus) {
+        processes.reserve(jobs.size());
+        index.reserve(jobs.size());
+        //One change when each job is admitted and one when it ends; only swapping adds more
+        memory_samples.reserve(2 * jobs.size() + 1);
+        for (const auto &job : jobs) {
+            process_metrics metrics;
+            metrics.PID = job.PID;
+            metrics.size = job.size;
+            metrics.arrival_time = job.arrival_time;
+            metrics.processing_time = job.processing_time;
+            index[job.PID] = processes.size();
+            processes.push_back(metrics);
+        }
+    }
+
+    void transition(unsigned int current_time, unsigned int cpu, int PID, states old_state, states new_state) override {
+        PROFILE_SCOPE(PHASE_OUTPUT);
+        if (next != nullptr) {
+            next->transition(current_time, cpu, PID, old_state, new_state);
+        }
+
+        process_metrics &p = processes[index[PID]];
+        if (old_state == RUNNING) {
+            busy_time += current_time - p.run_start;
+        }
+
+        if (old_state == NEW) {
+            hold_memory(current_time, memory_held + p.size);
+            p.admitted = current_time;
+            admission_sum += p.admission_delay();
+            admissions.add(p.admission_delay());
+        } else if (old_state == SUSPENDED_READY) {
+            hold_memory(current_time, memory_held + p.size);
+        } else if ((old_state == WAITING && new_state != SUSPENDED_WAITING) || old_state == SUSPENDED_WAITING) {
+            //Swapping out does not interrupt the I/O
+            p.io_time += current_time - p.io_start;
+        }
+
+        if (new_state == RUNNING) {
+            p.run_start = current_time;
+            if (p.first_run < 0) {
+                p.first_run = current_time;
+            }
+        } else if (new_state == WAITING) {
+            p.io_start = current_time;
+        } else if (new_state == SUSPENDED_WAITING) {
+            hold_memory(current_time, memory_held - p.size);
+        } else if (new_state == TERMINATED) {
+            p.finish = current_time;
+            hold_memory(current_time, memory_held - p.size);
+            completed(p);
+        }
+    }
+
+    void memory_snapshot(const memory_allocator &memory, unsigned int current_time) override {
+        PROFILE_SCOPE(PHASE_OUTPUT);
+        if (next != nullptr) {
+            next->memory_snapshot(memory, current_time);
+        }
+        if (memory_total == 0) {
+            memory.layout(blocks);
+            for (const auto &block : blocks) {
+                memory_total += block.size;
+            }
+        }
+    }
+
+    void finish() override {
+        PROFILE_SCOPE(PHASE_OUTPUT);
+        if (next != nullptr) {
+            next->finish();
+        }
+    }
+
+    void save(checkpoint_writer &out) override {
+        if (next != nullptr) {
+            next->save(out);
+        }
+        out.put_vector(processes);
+        out.put(finished);
+        out.put(makespan);
+        out.put(turnaround_sum);
+        out.put(wait_sum);
+        out.put(response_sum);
+        out.put(admission_sum);
+        turnarounds.save(out);
+        waits.save(out);
+        responses.save(out);
+        admissions.save(out);
+        out.put(busy_time);
+        out.put(memory_total);
+        out.put(memory_held);
+        out.put(memory_peak);
+        out.put(memory_since);
+        out.put(memory_area);
+        out.put_vector(memory_samples);
+    }
+
+    bool load(checkpoint_reader &in) override {
+        std::size_t jobs = processes.size();
+        if ((next != nullptr && !next->load(in)) || !in.get_vector(processes) || processes.size() != jobs) {
+            return false;
+        }
+        return in.get(finished) && in.get(makespan) && in.get(turnaround_sum) && in.get(wait_sum) && in.get(response_sum)
+               && in.get(admission_sum) && turnarounds.load(in) && waits.load(in) && responses.load(in) && admissions.load(in)
+               && in.get(busy_time) && in.get(memory_total)
+               && in.get(memory_held) && in.get(memory_peak) && in.get(memory_since) && in.get(memory_area)
+               && in.get_vector(memory_samples);
+    }
+
+    const std::vector<process_metrics>& per_process() const {
+        return processes;
+    }
+
+    //Memory held over time, one sample per instant at which it changed
+    const std::vector<memory_sample>& memory_series() const {
+        return memory_samples;
+    }
+
+    run_metrics summary() const {
+        run_metrics result;
+        result.processes = processes.size();
+        result.completed = finished;
+        result.makespan = makespan;
+        result.turnaround = distribution(turnaround_sum, turnarounds);
+        result.wait = distribution(wait_sum, waits);
+        result.response = distribution(response_sum, responses);
+        result.admission = distribution(admission_sum, admissions);
+        result.memory_total = memory_total;
+        result.memory_peak = memory_peak;
+
+        if (makespan > 0) {
+            result.throughput = (double)finished / makespan;
+            result.cpu_utilization = (double)busy_time / ((double)makespan * cpus);
+            if (memory_total > 0) {
+                result.memory_utilization = memory_area / ((double)memory_total * makespan);
+            }
+        }
+        return result;
+    }
+
+private:
+    void completed(const process_metrics &p) {
+        finished++;
+        makespan = std::max<unsigned int>(makespan, p.finish);
+        turnaround_sum += p.turnaround();
+        wait_sum += p.wait();
+        response_sum += p.response();
+        turnarounds.add(p.turnaround());
+        waits.add(p.wait());
+        responses.add(p.response());
+    }
+
+    //Closes the interval the current amount was held for and starts a new one. Changes at the same
+    //instant fold into one sample
+    void hold_memory(unsigned int current_time, unsigned int held) {
+        memory_area += (double)memory_held * (current_time - memory_since);
+        memory_since = current_time;
+        memory_held = held;
+        memory_peak = std::max(memory_peak, held);
+        if (!memory_samples.empty() && memory_samples.back().time == current_time) {
+            memory_samples.back().held = held;
+        } else {
+            memory_samples.push_back({current_time, held});
+        }
+    }
+
+    metric_distribution distribution(double sum, const quantile_sketch &sketch) const {
+        metric_distribution result;
+        if (sketch.count() > 0) {
+            result.mean = sum / sketch.count();
+            result.p50 = sketch.quantile(0.50);
+            result.p95 = sketch.quantile(0.95);
+            result.p99 = sketch.quantile(0.99);
+        }
+        return result;
+    }
+
+    trace_sink*                             next;
+    unsigned int                            cpus;
+    std::vector<process_metrics>            processes;
+    std::unordered_map<int, std::size_t>    index;
+    std::vector<memory_partition>           blocks;
+
+    std::size_t         finished = 0;
+    unsigned int        makespan = 0;
+    double              turnaround_sum = 0;
+    double              wait_sum = 0;
+    double              response_sum = 0;
+    double              admission_sum = 0;
+    quantile_sketch     turnarounds;
+    quantile_sketch     waits;
+    quantile_sketch     responses;
+    quantile_sketch     admissions;
+
+    unsigned long long  busy_time = 0;
+
+    unsigned int        memory_total = 0;
+    unsigned int        memory_held = 0;
+    unsigned int        memory_peak = 0;
+    unsigned int        memory_since = 0;
+    double              memory_area = 0;
+    std::vector<memory_sample>  memory_samples;
+};
+
+//------------------------------------METRICS REPORTS---------------------------------------------------
+
+std::string metrics_file(const std::string &format, const std::string &directory) {
+    return directory + (format == "json" ? "/metrics.json" : "/metrics.txt");
+}
+
+std::string format_fixed(double value, int precision) {
+    char buffer[64];
+    std::snprintf(buffer, sizeof(buffer), "%.*f", precision, value);
+    return buffer;
+}
+
+const std::size_t METRICS_CELL_WIDTH = 11;
+
+//Writes a border or a row of right-aligned cells for a table of the given number of columns
+void write_metrics_border(trace_writer &out, std::size_t columns) {
+    out.write("+");
+    for (std::size_t i = 1; i < columns * (METRICS_CELL_WIDTH + 2); i++) {
+        out.write('-');
+    }
+    out.write("+\n");
+}
+
+void write_metrics_row(trace_writer &out, const std::vector<std::string> &cells) {
+    out.write("|");
+    for (const auto &cell : cells) {
+        out.write_padded(cell.c_str(), METRICS_CELL_WIDTH);
+        out.write(" |");
+    }
+    out.write("\n");
+}
+
+void write_distribution_row(trace_writer &out, const char* name, const metric_distribution &d) {
+    write_metrics_row(out, {name, format_fixed(d.mean, 2), format_fixed(d.p50, 2), format_fixed(d.p95, 2), format_fixed(d.p99, 2)});
+}
+
+//Aggregates, one row per process and the memory held over time, in the boxed style of execution.txt
+void write_metrics_text(trace_writer &out, const metrics_trace_sink &metrics) {
+    run_metrics m = metrics.summary();
+
+    out.write("--- Scheduling Metrics ---\n");
+    out.write("Processes: ");
+    out.write_int(m.processes);
+    out.write(" (");
+    out.write_int(m.completed);
+    out.write(" completed)\nMakespan: ");
+    out.write_int(m.makespan);
+    out.write(" ms\nThroughput: ");
+    out.write(format_fixed(m.throughput, 6));
+    out.write(" processes/ms\nCPU utilization: ");
+    out.write(format_fixed(100 * m.cpu_utilization, 2));
+    out.write("%\nMemory utilization: ");
+    out.write(format_fixed(100 * m.memory_utilization, 2));
+    out.write("% average, peak ");
+    out.write_int(m.memory_peak);
+    out.write(" of ");
+    out.write_int(m.memory_total);
+    out.write(" MB\n\n");
+
+    write_metrics_border(out, 5);
+    write_metrics_row(out, {"Metric", "Mean", "p50", "p95", "p99"});
+    write_metrics_border(out, 5);
+    write_distribution_row(out, "Turnaround", m.turnaround);
+    write_distribution_row(out, "Wait", m.wait);
+    write_distribution_row(out, "Response", m.response);
+    write_distribution_row(out, "Admission", m.admission);
+    write_metrics_border(out, 5);
+    out.write("\n");
+
+    write_metrics_border(out, 7);
+    write_metrics_row(out, {"PID", "Arrival", "Finish", "Turnaround", "Wait", "Response", "Admission"});
+    write_metrics_border(out, 7);
+    for (const auto &p : metrics.per_process()) {
+        std::string admission = (p.admitted < 0) ? "-" : std::to_string(p.admission_delay());
+        if (p.finish < 0) {
+            write_metrics_row(out, {std::to_string(p.PID), std::to_string(p.arrival_time), "-", "-", "-", "-", admission});
+        } else {
+            write_metrics_row(out, {std::to_string(p.PID), std::to_string(p.arrival_time), std::to_string(p.finish),
+                                    std::to_string(p.turnaround()), std::to_string(p.wait()), std::to_string(p.response()), admission});
+        }
+    }
+    write_metrics_border(out, 7);
+    out.write("\n");
+
+    write_metrics_border(out, 3);
+    write_metrics_row(out, {"Time", "Memory MB", "Memory %"});
+    write_metrics_border(out, 3);
+    for (const auto &sample : metrics.memory_series()) {
+        double share = (m.memory_total > 0) ? 100.0 * sample.held / m.memory_total : 0;
+        write_metrics_row(out, {std::to_string(sample.time), std::to_string(sample.held), format_fixed(share, 2)});
+    }
+    write_metrics_border(out, 3);
+}
+
+void write_distribution_json(trace_writer &out, const char* name, const metric_distribution &d) {
+    out.write("    \"");
+    out.write(name);
+    out.write("\": {\"mean\": ");
+    out.write(format_fixed(d.mean, 2));
+    out.write(", \"p50\": ");
+    out.write(format_fixed(d.p50, 2));
+    out.write(", \"p95\": ");
+    out.write(format_fixed(d.p95, 2));
+    out.write(", \"p99\": ");
+    out.write(format_fixed(d.p99, 2));
+    out.write("},\n");
+}
+
+//The same report as one JSON object; processes that never finished have null timings, and "memory" lists
+//the MB held from each time on
+void write_metrics_json(trace_writer &out, const metrics_trace_sink &metrics) {
+    run_metrics m = metrics.summary();
+
+    out.write("{\n  \"summary\": {\n    \"processes\": ");
+    out.write_int(m.processes);
+    out.write(",\n    \"completed\": ");
+    out.write_int(m.completed);
+    out.write(",\n    \"makespan\": ");
+    out.write_int(m.makespan);
+    out.write(",\n    \"throughput\": ");
+    out.write(format_fixed(m.throughput, 6));
+    out.write(",\n");
+    write_distribution_json(out, "turnaround", m.turnaround);
+    write_distribution_json(out, "wait", m.wait);
+    write_distribution_json(out, "response", m.response);
+    write_distribution_json(out, "admission", m.admission);
+    out.write("    \"cpu_utilization\": ");
+    out.write(format_fixed(m.cpu_utilization, 6));
+    out.write(",\n    \"memory_total\": ");
+    out.write_int(m.memory_total);
+    out.write(",\n    \"memory_peak\": ");
+    out.write_int(m.memory_peak);
+    out.write(",\n    \"memory_utilization\": ");
+    out.write(format_fixed(m.memory_utilization, 6));
+    out.write("\n  },\n  \"processes\": [");
+
+    const char* separator = "\n";
+    for (const auto &p : metrics.per_process()) {
+        out.write(separator);
+        out.write("    {\"pid\": ");
+        out.write_int(p.PID);
+        out.write(", \"arrival\": ");
+        out.write_int(p.arrival_time);
+        out.write(", \"admission\": ");
+        if (p.admitted < 0) {
+            out.write("null");
+        } else {
+            out.write_int(p.admission_delay());
+        }
+        if (p.finish < 0) {
+            out.write(", \"finish\": null, \"turnaround\": null, \"wait\": null, \"response\": null}");
+        } else {
+            out.write(", \"finish\": ");
+            out.write_int(p.finish);
+            out.write(", \"turnaround\": ");
+            out.write_int(p.turnaround());
+            out.write(", \"wait\": ");
+            out.write_int(p.wait());
+            out.write(", \"response\": ");
+            out.write_int(p.response());
+            out.write("}");
+        }
+        separator = ",\n";
+    }
+    out.write("\n  ],\n  \"memory\": [");
+
+    separator = "\n";
+    for (const auto &sample : metrics.memory_series()) {
+        out.write(separator);
+        out.write("    {\"time\": ");
+        out.write_int(sample.time);
+        out.write(", \"held\": ");
+        out.write_int(sample.held);
+        out.write("}");
+        separator = ",\n";
+    }
+    out.write("\n  ]\n}\n");
+}
+
+//Writes the report in the given format (text or json) to directory/metrics.txt or metrics.json. Returns
+//false if the file cannot be opened or written
+bool write_metrics(const std::string &format, const std::string &directory, const metrics_trace_sink &metrics) {
+    trace_writer out(metrics_file(format, directory).c_str());
+    if (!out.is_open()) {
+        return false;
+    }
+    if (format == "json") {
+        write_metrics_json(out, metrics);
+    } else {
+        write_metrics_text(out, metrics);
+    }
+    return out.close();
+}
+
+#endif
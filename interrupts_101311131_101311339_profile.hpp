@@ -0,0 +1,398 @@
+/**
+ * @file interrupts_101311131_101311339_profile.hpp
+ * @author Sasisekhar Govind, Yuvraj Bains, James Bian
+ * @brief Hot path instrumentation: per-phase cycle and call counts, queue length histograms and an optional
+ *        Chrome trace-event export. Compiled in only with -DINTERRUPTS_PROFILE ("bash build.sh profile")
+ *
+ */
+
+#ifndef INTERRUPTS_PROFILE_HPP_
+#define INTERRUPTS_PROFILE_HPP_
+
+#include<string>
+
+//------------------------------------PHASES------------------------------------------------------------
+//SETUP builds the process table and sorts the arrivals, WAKEUP to ADVANCE are the phases of step_simulation,
+//OUTPUT is the trace sinks formatting and writing, CHECKPOINT is writing checkpoints. Each phase's time is its own:
+//output written while dispatching counts as OUTPUT, not DISPATCH.
+
+enum profile_phase {
+    PHASE_SETUP,
+    PHASE_WAKEUP,
+    PHASE_SWAP_IN,
+    PHASE_WAIT_QUEUE,
+    PHASE_ADMISSION,
+    PHASE_PREEMPTION,
+    PHASE_DISPATCH,
+    PHASE_EXECUTE,
+    PHASE_ADVANCE,
+    PHASE_OUTPUT,
+    PHASE_CHECKPOINT,
+    PHASE_COUNT
+};
+
+//Queue lengths sampled once per simulated step
+enum profile_queue {
+    QUEUE_READY,        //Summed over every CPU's ready queue
+    QUEUE_WAITING,      //Processes on I/O
+    QUEUE_PENDING,      //Jobs waiting for memory
+    QUEUE_EVENTS,       //Scheduled events
+    QUEUE_COUNT
+};
+
+#ifdef INTERRUPTS_PROFILE
+
+#include<algorithm>
+#include<atomic>
+#include<chrono>
+#include<cstdint>
+#include<cstdio>
+#include<iostream>
+#include<iomanip>
+#include<mutex>
+#include<vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include<x86intrin.h>
+#endif
+
+const char* phase_names[] = {"setup", "wakeup", "swap-in", "wait queue", "admission", "preemption", "dispatch",
+                             "execute", "advance", "output", "checkpoint"};
+
+const char* queue_names[] = {"ready", "waiting", "pending", "events"};
+
+//------------------------------------CLOCK-------------------------------------------------------------
+//The time stamp counter where there is one, as it costs a few ns against steady_clock's tens; its rate is
+//measured against steady_clock over the whole run to convert cycles to time for the report and the trace.
+
+#if defined(__x86_64__) || defined(__i386__)
+const char* PROFILE_CLOCK = "rdtsc";
+
+inline std::uint64_t profile_now() {
+    return __rdtsc();
+}
+#else
+const char* PROFILE_CLOCK = "steady_clock";
+
+inline std::uint64_t profile_now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+#endif
+
+//------------------------------------COUNTERS----------------------------------------------------------
+
+//Lengths in power of two buckets: bucket 0 holds 0, bucket b holds [2^(b-1), 2^b)
+struct profile_histogram {
+    std::uint64_t   buckets[65] = {};
+    std::uint64_t   samples = 0;
+    std::uint64_t   sum = 0;
+    std::uint64_t   max = 0;
+
+    void add(std::uint64_t value) {
+        buckets[value == 0 ? 0 : 64 - __builtin_clzll(value)]++;
+        samples++;
+        sum += value;
+        max = value > max ? value : max;
+    }
+
+    void merge(const profile_histogram &other) {
+        for (int b = 0; b < 65; b++) {
+            buckets[b] += other.buckets[b];
+        }
+        samples += other.samples;
+        sum += other.sum;
+        max = other.max > max ? other.max : max;
+    }
+
+    //Upper bound of the bucket holding the given quantile
+    std::uint64_t quantile(double q) const {
+        std::uint64_t seen = 0;
+        for (int b = 0; b < 65; b++) {
+            seen += buckets[b];
+            if (seen > 0 && seen >= q * samples) {
+                return b == 0 ? 0 : std::min<std::uint64_t>(max, (b == 64 ? UINT64_MAX : (1ULL << b) - 1));
+            }
+        }
+        return max;
+    }
+};
+
+//One entry of the Chrome trace: a phase (or with phase == PHASE_COUNT, a whole step) or, for kind
+//COUNTER, the queue lengths at the end of a step
+struct profile_event {
+    enum kind_t : std::uint8_t {SPAN, COUNTER};
+
+    std::uint64_t   start;
+    std::uint64_t   duration;
+    std::uint32_t   tick;
+    std::uint32_t   thread;
+    std::uint8_t    kind;
+    std::uint8_t    phase;
+    std::uint32_t   queues[QUEUE_COUNT];
+};
+
+//Events kept per thread; a long run stops recording there and the trace says how many were dropped
+const std::size_t PROFILE_TRACE_LIMIT = 1 << 20;
+
+struct profile_counters {
+    std::uint64_t       cycles[PHASE_COUNT] = {};
+    std::uint64_t       calls[PHASE_COUNT] = {};
+    profile_histogram   queues[QUEUE_COUNT];
+    std::vector<profile_event>  events;
+    std::uint64_t       dropped = 0;
+};
+
+struct profile_scope;
+
+//Everything one thread has counted. Merged into the process totals when the thread ends
+struct profile_thread {
+    profile_counters    counters;
+    profile_scope*      current = nullptr;  //Innermost open scope
+    std::uint32_t       id;
+    bool                tracing;
+
+    profile_thread();
+    ~profile_thread();
+
+    void record(const profile_event &event) {
+        if (counters.events.size() >= PROFILE_TRACE_LIMIT) {
+            counters.dropped++;
+            return;
+        }
+        counters.events.push_back(event);
+    }
+};
+
+//The process totals; the destructor prints the summary and writes the trace at exit
+struct profile_report {
+    std::mutex          lock;
+    profile_counters    totals;
+    std::string         trace_file;
+    std::atomic<std::uint32_t>  threads{0};
+    std::atomic<bool>   tracing{false};
+    std::uint64_t       start_cycles = profile_now();
+    std::chrono::steady_clock::time_point   start_time = std::chrono::steady_clock::now();
+
+    ~profile_report();
+
+    void merge(profile_counters &counters) {
+        std::lock_guard<std::mutex> guard(lock);
+        for (int p = 0; p < PHASE_COUNT; p++) {
+            totals.cycles[p] += counters.cycles[p];
+            totals.calls[p] += counters.calls[p];
+        }
+        for (int q = 0; q < QUEUE_COUNT; q++) {
+            totals.queues[q].merge(counters.queues[q]);
+        }
+        totals.events.insert(totals.events.end(), counters.events.begin(), counters.events.end());
+        totals.dropped += counters.dropped;
+    }
+
+    //Nanoseconds per cycle, measured over the run so far
+    double ns_per_cycle() const {
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start_time).count();
+        std::uint64_t cycles = profile_now() - start_cycles;
+        return cycles > 0 ? ns / cycles : 1;
+    }
+
+    void print_summary(std::ostream &out, double scale) const;
+    bool write_trace(double scale) const;
+};
+
+profile_report profile_totals;
+thread_local profile_thread profile_local;
+
+profile_thread::profile_thread() : id(profile_totals.threads++), tracing(profile_totals.tracing) {}
+
+profile_thread::~profile_thread() {
+    profile_totals.merge(counters);
+}
+
+//------------------------------------SCOPES------------------------------------------------------------
+//A scope charges the time since it opened, minus that of the scopes nested inside it, to its phase. next()
+//closes the current phase and opens another, so step_simulation's phases need no extra braces. A scope for
+//the phase already open inside it (a sink forwarding to the next) is not counted twice.
+
+struct profile_scope {
+    profile_thread  &thread = profile_local;    //Looked up once, as every thread_local access goes through a call
+    profile_phase   phase;
+    std::uint64_t   start;
+    std::uint64_t   nested = 0;     //Cycles spent in scopes inside this one
+    profile_scope*  parent;
+    bool            counted;
+
+    explicit profile_scope(profile_phase phase) : phase(phase), parent(thread.current) {
+        counted = parent == nullptr || parent->phase != phase;
+        if (counted) {
+            thread.current = this;
+            start = profile_now();
+        }
+    }
+
+    ~profile_scope() {
+        if (counted) {
+            close(profile_now());
+            thread.current = parent;
+        }
+    }
+
+    void next(profile_phase following) {
+        std::uint64_t now = profile_now();
+        close(now);
+        phase = following;
+        start = now;
+        nested = 0;
+    }
+
+private:
+    void close(std::uint64_t now) {
+        std::uint64_t elapsed = now - start;
+        thread.counters.cycles[phase] += elapsed - nested;
+        thread.counters.calls[phase]++;
+        if (parent != nullptr) {
+            parent->nested += elapsed;
+        }
+        if (thread.tracing) {
+            thread.record({start, elapsed, 0, thread.id, profile_event::SPAN, (std::uint8_t)phase, {}});
+        }
+    }
+};
+
+//Times a whole simulated step for the trace and samples the queue lengths at its end
+struct profile_step {
+    profile_thread  &thread = profile_local;
+    std::uint64_t   start = profile_now();
+    std::uint32_t   tick;
+
+    explicit profile_step(unsigned int tick) : tick(tick) {}
+
+    void queues(std::size_t ready, std::size_t waiting, std::size_t pending, std::size_t events) {
+        std::size_t lengths[QUEUE_COUNT] = {ready, waiting, pending, events};
+        for (int q = 0; q < QUEUE_COUNT; q++) {
+            thread.counters.queues[q].add(lengths[q]);
+        }
+        if (thread.tracing) {
+            profile_event counter = {profile_now(), 0, tick, thread.id, profile_event::COUNTER, PHASE_COUNT, {}};
+            for (int q = 0; q < QUEUE_COUNT; q++) {
+                counter.queues[q] = lengths[q];
+            }
+            thread.record(counter);
+        }
+    }
+
+    ~profile_step() {
+        if (thread.tracing) {
+            thread.record({start, profile_now() - start, tick, thread.id, profile_event::SPAN, PHASE_COUNT, {}});
+        }
+    }
+};
+
+//------------------------------------REPORT------------------------------------------------------------
+
+void profile_report::print_summary(std::ostream &out, double scale) const {
+    std::uint64_t total = 0;
+    for (int p = 0; p < PHASE_COUNT; p++) {
+        total += totals.cycles[p];
+    }
+
+    out << "--- Profile (" << PROFILE_CLOCK << ", " << std::fixed << std::setprecision(3) << scale << " ns per cycle) ---" << std::endl;
+    out << std::left << std::setw(14) << "Phase" << std::right << std::setw(14) << "Calls" << std::setw(18) << "Cycles"
+        << std::setw(14) << "ns/call" << std::setw(10) << "Share" << std::endl;
+    out << std::string(70, '-') << std::endl;
+    for (int p = 0; p < PHASE_COUNT; p++) {
+        double per_call = totals.calls[p] > 0 ? totals.cycles[p] * scale / totals.calls[p] : 0;
+        double share = total > 0 ? 100.0 * totals.cycles[p] / total : 0;
+        out << std::left << std::setw(14) << phase_names[p] << std::right << std::setw(14) << totals.calls[p]
+            << std::setw(18) << totals.cycles[p] << std::setw(14) << std::setprecision(1) << per_call
+            << std::setw(9) << share << "%" << std::endl;
+    }
+
+    out << std::endl << std::left << std::setw(14) << "Queue" << std::right << std::setw(14) << "Samples" << std::setw(12) << "Mean"
+        << std::setw(10) << "p50" << std::setw(10) << "p99" << std::setw(10) << "Max" << std::endl;
+    out << std::string(70, '-') << std::endl;
+    for (int q = 0; q < QUEUE_COUNT; q++) {
+        const profile_histogram &h = totals.queues[q];
+        out << std::left << std::setw(14) << queue_names[q] << std::right << std::setw(14) << h.samples << std::setw(12)
+            << std::setprecision(2) << (h.samples > 0 ? (double)h.sum / h.samples : 0) << std::setw(10) << h.quantile(0.5)
+            << std::setw(10) << h.quantile(0.99) << std::setw(10) << h.max << std::endl;
+    }
+    out << "(p50 and p99 are the upper ends of power of two buckets)" << std::endl;
+}
+
+//Writes the Chrome trace-event JSON, loadable in chrome://tracing or Perfetto. Returns false if the file
+//cannot be opened
+bool profile_report::write_trace(double scale) const {
+    std::FILE* file = std::fopen(trace_file.c_str(), "w");
+    if (file == nullptr) {
+        return false;
+    }
+
+    std::fprintf(file, "{\"displayTimeUnit\":\"ns\",\"otherData\":{\"clock\":\"%s\",\"dropped_events\":%llu},\"traceEvents\":[\n",
+                 PROFILE_CLOCK, (unsigned long long)totals.dropped);
+    bool first = true;
+    for (const auto &event : totals.events) {
+        double ts = (double)(event.start - start_cycles) * scale / 1000;
+        std::fprintf(file, first ? "" : ",\n");
+        first = false;
+        if (event.kind == profile_event::COUNTER) {
+            std::fprintf(file, "{\"name\":\"queues\",\"ph\":\"C\",\"ts\":%.3f,\"pid\":1,\"tid\":%u,\"args\":{", ts, event.thread);
+            for (int q = 0; q < QUEUE_COUNT; q++) {
+                std::fprintf(file, "%s\"%s\":%u", q > 0 ? "," : "", queue_names[q], event.queues[q]);
+            }
+            std::fprintf(file, "}}");
+        } else if (event.phase == PHASE_COUNT) {
+            std::fprintf(file, "{\"name\":\"step\",\"cat\":\"step\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u,\"args\":{\"tick\":%u}}",
+                         ts, event.duration * scale / 1000, event.thread, event.tick);
+        } else {
+            std::fprintf(file, "{\"name\":\"%s\",\"cat\":\"phase\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u}",
+                         phase_names[event.phase], ts, event.duration * scale / 1000, event.thread);
+        }
+    }
+    std::fprintf(file, "\n]}\n");
+    return std::fclose(file) == 0;
+}
+
+profile_report::~profile_report() {
+    double scale = ns_per_cycle();
+    print_summary(std::cerr, scale);
+    if (!trace_file.empty()) {
+        if (!write_trace(scale)) {
+            std::cerr << "Error opening file!" << std::endl;
+        } else {
+            std::cerr << "Profile trace written to " << trace_file << (totals.dropped > 0 ? " (" + std::to_string(totals.dropped)
+                         + " events past the limit dropped)" : "") << std::endl;
+        }
+    }
+}
+
+//Turns on the Chrome trace for threads started from now on, written to file at exit. Returns false in a
+//build without profiling
+bool profile_trace_to(const std::string &file) {
+    profile_totals.trace_file = file;
+    profile_totals.tracing = true;
+    profile_local.tracing = true;
+    return true;
+}
+
+#define PROFILE_SCOPE(phase)        profile_scope profile_scope_##phase(phase)
+#define PROFILE_BEGIN(phase)        profile_scope profile_phase_scope(phase)
+#define PROFILE_NEXT(phase)         profile_phase_scope.next(phase)
+#define PROFILE_STEP(tick)          profile_step profile_current_step(tick)
+#define PROFILE_QUEUES(ready, waiting, pending, events) profile_current_step.queues(ready, waiting, pending, events)
+
+#else
+
+//Without INTERRUPTS_PROFILE every hook compiles to nothing
+
+bool profile_trace_to(const std::string &) {
+    return false;
+}
+
+#define PROFILE_SCOPE(phase)
+#define PROFILE_BEGIN(phase)
+#define PROFILE_NEXT(phase)
+#define PROFILE_STEP(tick)
+#define PROFILE_QUEUES(ready, waiting, pending, events)
+
+#endif
+
+#endif
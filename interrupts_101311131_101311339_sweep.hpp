@@ -0,0 +1,216 @@
+/**
+ * @file interrupts_101311131_101311339_sweep.hpp
+ * @author Sasisekhar Govind, Yuvraj Bains, James Bian
+ * @brief Sweep mode: runs every combination of trace, policy, time quantum and partition layout in parallel
+ *        and tabulates the scheduling metrics of each as CSV
+ *
+ */
+
+#ifndef INTERRUPTS_SWEEP_HPP_
+#define INTERRUPTS_SWEEP_HPP_
+
+#include "interrupts_101311131_101311339_batch.hpp"
+#include "interrupts_101311131_101311339_metrics.hpp"
+
+//------------------------------------PARAMETER SWEEP---------------------------------------------------
+//Each trace is loaded once and shared read-only by its runs. A run only feeds a metrics_trace_sink, so
+//no logs are written and hundreds of configurations finish in seconds.
+
+struct sweep_run {
+    std::size_t                 trace;
+    std::string                 policy;
+    unsigned int                quantum;            //0 for the policies that do not use --quantum
+    std::size_t                 layout;
+    run_metrics                 metrics;
+};
+
+//Upper bound on the configurations one sweep may expand to, so a typo like 1:4000000000 is rejected
+//instead of queueing billions of runs
+const std::size_t MAX_SWEEP_RUNS = 100000;
+
+//Parses "25,50,100:500:100" into the listed quanta; a start:end[:step] range includes both ends and
+//steps by 1 unless told otherwise. Returns false on anything malformed or longer than MAX_SWEEP_RUNS
+bool parse_quanta(const std::string &spec, std::vector<unsigned int> &quanta) {
+    try {
+        for (const auto &item : split_delim(spec, ",")) {
+            std::vector<std::string> range = split_delim(item, ":");
+            unsigned int start = std::stoul(range[0]);
+            unsigned int end = range.size() > 1 ? std::stoul(range[1]) : start;
+            unsigned int step = range.size() > 2 ? std::stoul(range[2]) : 1;
+            if (range.size() > 3 || start == 0 || step == 0 || end < start) {
+                return false;
+            }
+            for (unsigned int quantum = start; ; quantum += step) {
+                if (quanta.size() == MAX_SWEEP_RUNS) {
+                    return false;
+                }
+                quanta.push_back(quantum);
+                if (end - quantum < step) {
+                    break;
+                }
+            }
+        }
+    } catch (const std::exception &) {
+        return false;
+    }
+    return !quanta.empty();
+}
+
+//Parses "40,25,15,10,8,2/50,50" into partition layouts. Returns false on anything malformed
+bool parse_layouts(const std::string &spec, std::vector<std::vector<unsigned int>> &layouts) {
+    try {
+        for (const auto &item : split_delim(spec, "/")) {
+            std::vector<unsigned int> layout;
+            for (const auto &size : split_delim(item, ",")) {
+                layout.push_back(std::stoul(size));
+            }
+            layouts.push_back(layout);
+        }
+    } catch (const std::exception &) {
+        return false;
+    }
+    return !layouts.empty();
+}
+
+std::string layout_name(const std::vector<unsigned int> &layout) {
+    std::string name;
+    for (std::size_t i = 0; i < layout.size(); i++) {
+        name += (i > 0 ? "," : "") + std::to_string(layout[i]);
+    }
+    return name;
+}
+
+//Writes one CSV row per run. Returns false if the file cannot be opened
+bool write_sweep_csv(const std::string &filename, const std::vector<sweep_run> &runs, const std::vector<std::string> &traces,
+                     const std::vector<std::vector<unsigned int>> &layouts) {
+    std::ofstream csv(filename);
+    if (!csv.is_open()) {
+        return false;
+    }
+
+    csv << "trace,policy,quantum,partitions,processes,completed,makespan,throughput,mean_turnaround,mean_wait,mean_response,mean_admission\n";
+    csv << std::fixed;
+    for (const auto &run : runs) {
+        const run_metrics &m = run.metrics;
+        csv << traces[run.trace] << ',' << run.policy << ',';
+        if (run.quantum > 0) {
+            csv << run.quantum;
+        }
+        csv << ",\"" << layout_name(layouts[run.layout]) << "\"," << m.processes << ',' << m.completed << ',' << m.makespan << ','
+            << std::setprecision(6) << m.throughput << ',' << std::setprecision(2) << m.turnaround.mean << ','
+            << m.wait.mean << ',' << m.response.mean << ',' << m.admission.mean << '\n';
+    }
+    return csv.good();
+}
+
+//Entry point for "bin/interrupts --sweep <directory|trace|manifest> [options]". Returns the process exit code
+int sweep_main(int argc, char** argv) {
+
+    run_options options;
+    std::vector<unsigned int> quanta;
+    std::vector<std::vector<unsigned int>> layouts;
+    if(argc < 3 || !parse_run_options(argc, argv, 3, options) || !parse_quanta(options.quanta, quanta)
+       || !parse_layouts(options.layouts.empty() ? layout_name(options.memory.partitions) : options.layouts, layouts)) {
+        std::cout << "Usage: " << argv[0] << " --sweep <input_directory|trace|manifest> [--policies EP,RR,EP_RR,MLFQ,SJF,SRTF,STRIDE,LOTTERY] [--quanta 25,50,100:500:100] "
+                  << "[--layouts 40,25,15,10,8,2/50,50] [--memory fixed|first-fit|best-fit|next-fit|buddy] [--memory-size <MB>] "
+                  << "[--admission fifo|best-fit|largest-first] [--swap none|longest-io|smallest] [--cpus <n>] "
+                  << "[--jobs <threads>] [--csv <file>]" << std::endl;
+        return -1;
+    }
+
+    if (!options.checkpoint.file.empty() || !options.checkpoint.resume.empty() || !options.profile_trace.empty()) {
+        std::cerr << "Error: --checkpoint, --resume and --profile-trace only apply to single runs" << std::endl;
+        return -1;
+    }
+    std::vector<std::string> policies = split_delim(options.policies, ",");
+    for (const auto &policy : policies) {
+        if (!known_policy(policy)) {
+            std::cerr << "Error: Unknown policy: " << policy << std::endl;
+            return -1;
+        }
+    }
+    if (!make_allocator(options.memory)) {
+        std::cerr << "Error: Unknown memory allocator: " << options.memory.allocator << std::endl;
+        return -1;
+    }
+
+    std::vector<std::string> traces;
+    std::string error;
+    if (!collect_traces(argv[2], traces, error)) {
+        std::cerr << "Error: " << error << std::endl;
+        return -1;
+    }
+    std::vector<std::vector<PCB>> workloads(traces.size());
+    for (std::size_t t = 0; t < traces.size(); t++) {
+        if (!load_processes(traces[t].c_str(), workloads[t], error)) {
+            std::cerr << "Error: " << error << std::endl;
+            return -1;
+        }
+        for (const auto &layout : layouts) {
+            memory_config config = options.memory;
+            config.partitions = layout;
+            if (!check_memory_size(config, error)) {
+                std::cerr << "Error: Layout " << layout_name(layout) << ": " << error << std::endl;
+                return -1;
+            }
+            if (!check_job_sizes(workloads[t], *make_allocator(config), error)) {
+                std::cerr << "Error: " << traces[t] << ": " << error << std::endl;
+                return -1;
+            }
+        }
+    }
+
+    std::size_t quantum_policies = 0;
+    for (const auto &policy : policies) {
+        quantum_policies += uses_quantum(policy) ? 1 : 0;
+    }
+    std::size_t per_layout = (policies.size() - quantum_policies) + quantum_policies * quanta.size();
+    if (per_layout > MAX_SWEEP_RUNS / layouts.size() / traces.size()) {
+        std::cerr << "Error: Sweep expands to more than " << MAX_SWEEP_RUNS << " configurations" << std::endl;
+        return -1;
+    }
+
+    std::vector<sweep_run> runs;
+    for (std::size_t t = 0; t < traces.size(); t++) {
+        for (const auto &policy : policies) {
+            for (std::size_t l = 0; l < layouts.size(); l++) {
+                if (!uses_quantum(policy)) {
+                    runs.push_back({t, policy, 0, l, run_metrics()});
+                    continue;
+                }
+                for (unsigned int quantum : quanta) {
+                    runs.push_back({t, policy, quantum, l, run_metrics()});
+                }
+            }
+        }
+    }
+
+    unsigned int threads = worker_threads(options.jobs, runs.size());
+    run_parallel(runs.size(), threads, [&](std::size_t i) {
+        sweep_run &run = runs[i];
+        memory_config config = options.memory;
+        config.partitions = layouts[run.layout];
+        std::unique_ptr<memory_allocator> memory = make_allocator(config);
+
+        run_options run_config = options;
+        run_config.quantum = run.quantum;
+        metrics_trace_sink metrics(workloads[run.trace], nullptr, options.cpu.cpus);
+        run_policy(run.policy, run_config, workloads[run.trace], *memory, metrics);
+        run.metrics = metrics.summary();
+    });
+
+    std::error_code ec;
+    std::filesystem::path parent = std::filesystem::path(options.csv).parent_path();
+    if (!parent.empty()) {
+        std::filesystem::create_directories(parent, ec);
+    }
+    if (!write_sweep_csv(options.csv, runs, traces, layouts)) {
+        std::cerr << "Error opening file!" << std::endl;
+        return -1;
+    }
+
+    std::cout << runs.size() << " configurations simulated on " << threads << " threads, results in " << options.csv << std::endl;
+    return 0;
+}
+
+#endif
@@ -0,0 +1,362 @@
+/**
+ * @file interrupts_101311131_101311339_trace.hpp
+ * @author Sasisekhar Govind, Yuvraj Bains, James Bian
+ * @brief Trace sinks for the schedulers: the original text tables or a compact binary event log
+ *
+ */
+
+#ifndef INTERRUPTS_TRACE_HPP_
+#define INTERRUPTS_TRACE_HPP_
+
+#include "interrupts_101311131_101311339.hpp"
+#include<cstdint>
+
+//------------------------------------TRACE SINKS-------------------------------------------------------
+//The schedulers report every state transition and every memory snapshot to a trace_sink. The text sink
+//produces execution.txt and memory_status.txt exactly as before; the binary sink writes trace.bin, which
+//bin/trace_convert expands back into the same two text files.
+//Every transition names the CPU it happened on: the CPU that runs or ran the process, or the CPU whose
+//run queue it joins. Only multi-CPU runs show that in the execution table.
+
+class trace_sink {
+public:
+    virtual ~trace_sink() {}
+
+    virtual void transition(unsigned int current_time, unsigned int cpu, int PID, states old_state, states new_state) = 0;
+
+    virtual void memory_snapshot(const memory_allocator &memory, unsigned int current_time) = 0;
+
+    //Writes any trailer and flushes everything to disk
+    virtual void finish() = 0;
+
+    //Flushes what has been written and records where the output stands in a checkpoint.
+    //Sinks that keep nothing need not override these
+    virtual void save(checkpoint_writer &) {}
+
+    //Continues from a checkpoint, dropping any output written after it. Returns false on a mismatch
+    virtual bool load(checkpoint_reader &) {
+        return true;
+    }
+};
+
+class text_trace_sink : public trace_sink {
+public:
+    text_trace_sink(trace_writer &execution_log, trace_writer &memory_log, unsigned int cpus = 1)
+        : execution_log(execution_log), memory_log(memory_log), cpu_column(cpus > 1) {
+        execution_log.write(cpu_column ? print_smp_exec_header() : print_exec_header());
+        memory_log.write("--- Memory Usage Log ---\n");
+    }
+
+    void transition(unsigned int current_time, unsigned int cpu, int PID, states old_state, states new_state) override {
+        PROFILE_SCOPE(PHASE_OUTPUT);
+        if (cpu_column) {
+            write_exec_status(execution_log, current_time, cpu, PID, old_state, new_state);
+        } else {
+            write_exec_status(execution_log, current_time, PID, old_state, new_state);
+        }
+    }
+
+    void memory_snapshot(const memory_allocator &memory, unsigned int current_time) override {
+        PROFILE_SCOPE(PHASE_OUTPUT);
+        memory.layout(blocks);
+        write_memory_status(memory_log, blocks, current_time);
+    }
+
+    void finish() override {
+        PROFILE_SCOPE(PHASE_OUTPUT);
+        execution_log.write(cpu_column ? print_smp_exec_footer() : print_exec_footer());
+        execution_log.flush();
+        memory_log.flush();
+    }
+
+    void save(checkpoint_writer &out) override {
+        out.put(execution_log.sync());
+        out.put(memory_log.sync());
+    }
+
+    bool load(checkpoint_reader &in) override {
+        long long execution_offset, memory_offset;
+        return in.get(execution_offset) && in.get(memory_offset)
+               && execution_log.rewind_to(execution_offset) && memory_log.rewind_to(memory_offset);
+    }
+
+private:
+    trace_writer                    &execution_log;
+    trace_writer                    &memory_log;
+    bool                            cpu_column;
+    std::vector<memory_partition>   blocks;
+};
+
+//Discards everything, for runs that only want metrics
+class null_trace_sink : public trace_sink {
+public:
+    void transition(unsigned int, unsigned int, int, states, states) override {}
+
+    void memory_snapshot(const memory_allocator &, unsigned int) override {}
+
+    void finish() override {}
+};
+
+//------------------------------------BINARY TRACE FORMAT-----------------------------------------------
+//A 16 byte file header followed by 16 byte records, all in host byte order:
+//  TRACE_TRANSITION  time, value = PID, old_state/new_state, cpu
+//  TRACE_SNAPSHOT    time, value = number of TRACE_BLOCK records that follow, extra = number of blocks
+//  TRACE_BLOCK       time = block index, value = occupying PID or -1, extra = block size in MB
+//  TRACE_CPUS        value = number of CPUs; only multi-CPU traces have it, as their first record
+//A snapshot only carries the blocks that changed since the previous one.
+
+const char TRACE_MAGIC[8] = {'S', 'Y', 'S', 'C', 'T', 'R', 'C', '\0'};
+const std::uint32_t TRACE_VERSION = 1;
+
+enum trace_record_kind {
+    TRACE_TRANSITION,
+    TRACE_SNAPSHOT,
+    TRACE_BLOCK,
+    TRACE_CPUS
+};
+
+struct trace_file_header {
+    char            magic[8];
+    std::uint32_t   version;
+    std::uint32_t   record_size;
+};
+
+struct trace_record {
+    std::uint8_t    kind;
+    std::uint8_t    old_state;
+    std::uint8_t    new_state;
+    std::uint8_t    cpu;
+    std::uint32_t   time;
+    std::int32_t    value;
+    std::uint32_t   extra;
+};
+
+static_assert(sizeof(trace_file_header) == 16, "trace header must stay 16 bytes");
+static_assert(sizeof(trace_record) == 16, "trace records must stay 16 bytes");
+
+class binary_trace_sink : public trace_sink {
+public:
+    explicit binary_trace_sink(trace_writer &out, unsigned int cpus = 1) : out(out) {
+        trace_file_header header;
+        std::memcpy(header.magic, TRACE_MAGIC, sizeof(header.magic));
+        header.version = TRACE_VERSION;
+        header.record_size = sizeof(trace_record);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        if (cpus > 1) {
+            write_record(TRACE_CPUS, 0, cpus, 0, NEW, NEW);
+        }
+    }
+
+    void transition(unsigned int current_time, unsigned int cpu, int PID, states old_state, states new_state) override {
+        PROFILE_SCOPE(PHASE_OUTPUT);
+        write_record(TRACE_TRANSITION, current_time, PID, 0, old_state, new_state, cpu);
+    }
+
+    void memory_snapshot(const memory_allocator &memory, unsigned int current_time) override {
+        PROFILE_SCOPE(PHASE_OUTPUT);
+        memory.layout(blocks);
+
+        std::int32_t changed = 0;
+        for (std::size_t i = 0; i < blocks.size(); i++) {
+            if (block_changed(i)) {
+                changed++;
+            }
+        }
+
+        write_record(TRACE_SNAPSHOT, current_time, changed, blocks.size(), NEW, NEW);
+        for (std::size_t i = 0; i < blocks.size(); i++) {
+            if (block_changed(i)) {
+                write_record(TRACE_BLOCK, i, blocks[i].occupied, blocks[i].size, NEW, NEW);
+            }
+        }
+        previous.swap(blocks);
+    }
+
+    void finish() override {
+        PROFILE_SCOPE(PHASE_OUTPUT);
+        out.flush();
+    }
+
+    //Snapshots are deltas against previous, so it is part of the state
+    void save(checkpoint_writer &checkpoint) override {
+        checkpoint.put(out.sync());
+        checkpoint.put_vector(previous);
+    }
+
+    bool load(checkpoint_reader &checkpoint) override {
+        long long offset;
+        return checkpoint.get(offset) && checkpoint.get_vector(previous) && out.rewind_to(offset);
+    }
+
+private:
+    bool block_changed(std::size_t i) const {
+        return i >= previous.size() || previous[i].size != blocks[i].size || previous[i].occupied != blocks[i].occupied;
+    }
+
+    void write_record(trace_record_kind kind, std::uint32_t time, std::int32_t value, std::uint32_t extra, states old_state, states new_state,
+                      unsigned int cpu = 0) {
+        trace_record record;
+        record.kind = kind;
+        record.old_state = old_state;
+        record.new_state = new_state;
+        record.cpu = cpu;
+        record.time = time;
+        record.value = value;
+        record.extra = extra;
+        out.write(reinterpret_cast<const char*>(&record), sizeof(record));
+    }
+
+    trace_writer                    &out;
+    std::vector<memory_partition>   blocks;
+    std::vector<memory_partition>   previous;
+};
+
+//Opens the output files for the chosen trace format (text, binary or none) in directory, runs simulate(sink) and flushes everything.
+//cpus is the number of CPUs the run simulates. resume keeps the existing files, which the sink cuts back
+//to the checkpoint it loads. simulate returns false if the run failed, e.g. on a rejected checkpoint; the
+//buffered output is then dropped unfinished, so a resumed file is left as it was. Returns false if the run
+//failed or an output file could not be opened or written
+template <typename Simulation>
+bool run_traced(const std::string &format, const std::string &directory, unsigned int cpus, bool resume, Simulation simulate) {
+    if (format == "none") {
+        null_trace_sink trace;
+        return simulate(trace);
+    }
+    if (format == "binary") {
+        trace_writer binary_log((directory + "/trace.bin").c_str(), resume);
+        if (!binary_log.is_open()) {
+            return false;
+        }
+        binary_trace_sink trace(binary_log, cpus);
+        if (!simulate(trace)) {
+            binary_log.abandon();
+            return false;
+        }
+        trace.finish();
+        return binary_log.close();
+    }
+
+    trace_writer memory_log((directory + "/memory_status.txt").c_str(), resume);
+    trace_writer execution_log((directory + "/execution.txt").c_str(), resume);
+    if (!memory_log.is_open() || !execution_log.is_open()) {
+        return false;
+    }
+    text_trace_sink trace(execution_log, memory_log, cpus);
+    if (!simulate(trace)) {
+        memory_log.abandon();
+        execution_log.abandon();
+        return false;
+    }
+    trace.finish();
+    bool memory_written = memory_log.close();
+    return execution_log.close() && memory_written;
+}
+
+//Names of the files run_traced writes for the given format, for reporting
+std::string traced_files(const std::string &format, const std::string &directory) {
+    if (format == "none") {
+        return "";
+    }
+    if (format == "binary") {
+        return directory + "/trace.bin";
+    }
+    return directory + "/execution.txt and " + directory + "/memory_status.txt";
+}
+
+//Expands a binary trace into the text execution table and memory log. Returns false and fills in error
+//if the file cannot be read or is not a valid trace
+bool convert_binary_trace(const char* filename, trace_writer &execution_log, trace_writer &memory_log, std::string &error) {
+    std::FILE* in = std::fopen(filename, "rb");
+    if (in == nullptr) {
+        error = std::string("unable to open ") + filename;
+        return false;
+    }
+
+    trace_file_header header;
+    if (std::fread(&header, sizeof(header), 1, in) != 1 || std::memcmp(header.magic, TRACE_MAGIC, sizeof(header.magic)) != 0) {
+        std::fclose(in);
+        error = "not a binary trace file";
+        return false;
+    }
+    if (header.version != TRACE_VERSION || header.record_size != sizeof(trace_record)) {
+        std::fclose(in);
+        error = "unsupported trace version " + std::to_string(header.version);
+        return false;
+    }
+
+    //A multi-CPU trace announces its CPU count first, so the table can be given its CPU column
+    unsigned int cpus = 1;
+    trace_record first;
+    if (std::fread(&first, sizeof(first), 1, in) == 1 && first.kind == TRACE_CPUS) {
+        cpus = first.value;
+    } else {
+        std::fseek(in, sizeof(header), SEEK_SET);
+    }
+
+    text_trace_sink text(execution_log, memory_log, cpus);
+    std::vector<memory_partition> blocks;
+    std::vector<trace_record> records(4096);
+    std::size_t record_number = 0;
+    std::int32_t blocks_pending = 0;
+    unsigned int snapshot_time = 0;
+    bool ok = true;
+
+    //Read in bytes so a record cut off at the end of the file shows up as leftover bytes
+    std::size_t count;
+    std::size_t leftover = 0;
+    std::size_t bytes;
+    while (ok && (bytes = std::fread(records.data(), 1, records.size() * sizeof(trace_record), in)) > 0) {
+        count = bytes / sizeof(trace_record);
+        leftover = bytes % sizeof(trace_record);
+        for (std::size_t i = 0; i < count && ok; i++, record_number++) {
+            const trace_record &record = records[i];
+
+            if (blocks_pending > 0) {
+                if (record.kind != TRACE_BLOCK || record.time >= blocks.size()) {
+                    ok = false;
+                    break;
+                }
+                blocks[record.time] = {record.time + 1, record.extra, record.value};
+                if (--blocks_pending == 0) {
+                    write_memory_status(memory_log, blocks, snapshot_time);
+                }
+                continue;
+            }
+
+            if (record.kind == TRACE_TRANSITION && record.old_state <= SUSPENDED_WAITING && record.new_state <= SUSPENDED_WAITING) {
+                text.transition(record.time, record.cpu, record.value, (states)record.old_state, (states)record.new_state);
+            } else if (record.kind == TRACE_SNAPSHOT && record.value >= 0) {
+                snapshot_time = record.time;
+                blocks.resize(record.extra);
+                for (std::size_t b = 0; b < blocks.size(); b++) {
+                    blocks[b].partition_number = b + 1;
+                }
+                blocks_pending = record.value;
+                if (blocks_pending == 0) {
+                    write_memory_status(memory_log, blocks, snapshot_time);
+                }
+            } else {
+                ok = false;
+            }
+        }
+    }
+
+    bool read_failed = std::ferror(in) != 0;
+    std::fclose(in);
+    if (!ok) {
+        error = "corrupt record " + std::to_string(record_number);
+        return false;
+    }
+    if (read_failed) {
+        error = std::string("unable to read ") + filename;
+        return false;
+    }
+    if (leftover > 0 || blocks_pending > 0) {
+        error = "truncated trace";
+        return false;
+    }
+    text.finish();
+    return true;
+}
+
+#endif
@@ -0,0 +1,39 @@
+/**
+ * @file interrupts_101311131_101311339_trace_convert.cpp
+ * @author Sasisekhar Govind, Yuvraj Bains, James Bian
+ * @brief Expands a binary trace (--trace binary) back into execution.txt and memory_status.txt
+ */
+
+#include "interrupts_101311131_101311339_trace.hpp"
+
+int main(int argc, char** argv) {
+
+    if(argc != 2 && argc != 4) {
+        std::cout << "Usage: ./bin/trace_convert <trace.bin> [<execution.txt> <memory_status.txt>]" << std::endl;
+        return -1;
+    }
+
+    const char* execution_file = (argc == 4) ? argv[2] : "output_files/execution.txt";
+    const char* memory_file = (argc == 4) ? argv[3] : "output_files/memory_status.txt";
+
+    trace_writer execution_log(execution_file);
+    trace_writer memory_log(memory_file);
+    if (!execution_log.is_open() || !memory_log.is_open()) {
+        std::cerr << "Error opening file!" << std::endl;
+        return -1;
+    }
+
+    std::string error;
+    if (!convert_binary_trace(argv[1], execution_log, memory_log, error)) {
+        std::cerr << "Error: " << argv[1] << ": " << error << std::endl;
+        return -1;
+    }
+    bool memory_written = memory_log.close();
+    if (!execution_log.close() || !memory_written) {
+        std::cerr << "Error writing output files!" << std::endl;
+        return -1;
+    }
+
+    std::cout << "Output generated in " << execution_file << " and " << memory_file << std::endl;
+    return 0;
+}